@@ -56,13 +56,17 @@ vector<Amplitude*> AmpToolsInterface::m_userAmplitudes;
 vector<Neg2LnLikContrib*> AmpToolsInterface::m_userNeg2LnLikContribs;
 vector<DataReader*> AmpToolsInterface::m_userDataReaders;
 unsigned int AmpToolsInterface::m_randomSeed = 0;
+unsigned int AmpToolsInterface::m_preloadThreads = 0;
+map<DataReader*,unsigned int> AmpToolsInterface::m_dataReaderUsers;
 
 AmpToolsInterface::AmpToolsInterface( FunctionalityFlag flag ) :
 m_functionality( flag ),
 m_configurationInfo( NULL ),
 m_minuitMinimizationManager(NULL),
 m_parameterManager(NULL),
-m_fitResults(NULL)
+m_fitResults(NULL),
+m_useRandomStream( false ),
+m_randomStream( 0, 0 )
 {
   srand( m_randomSeed );
 }
@@ -73,7 +77,9 @@ m_functionality( flag ),
 m_configurationInfo(configurationInfo),
 m_minuitMinimizationManager(NULL),
 m_parameterManager(NULL),
-m_fitResults(NULL){
+m_fitResults(NULL),
+m_useRandomStream( false ),
+m_randomStream( 0, 0 ){
   
   resetConfigurationInfo(configurationInfo);
   srand( m_randomSeed );
@@ -197,49 +203,85 @@ AmpToolsInterface::resetConfigurationInfo(ConfigurationInfo* configurationInfo){
         report( WARNING, kModule ) << "not creating a DataReader for generated MC associated with reaction " << reactionName << endl;
       if (!accMCRdr)
         report( WARNING, kModule ) << "not creating a DataReader for accepted MC associated with reaction " << reactionName << endl;
-      
-      if( m_functionality == kFull ){
+    }
+  }
+  
+  for( std::set<DataReader*>::iterator dataReader = m_uniqueDataSets.begin();
+      dataReader != m_uniqueDataSets.end(); ++dataReader ){
+    
+    if( *dataReader ) ++m_dataReaderUsers[*dataReader];
+  }
+  
+  // ************************
+  // load all data sets at once if requested
+  // ************************
+  
+  bool preload = ( m_functionality == kFull && m_preloadThreads > 0 );
+  if( preload ) AmpVecs::preloadData( m_uniqueDataSets, m_preloadThreads );
+  
+  for (unsigned int irct = 0; irct < m_configurationInfo->reactionList().size(); irct++){
+    
+    ReactionInfo* reaction = m_configurationInfo->reactionList()[irct];
+    string reactionName(reaction->reactionName());
+    IntensityManager* intenMan = intensityManager(reactionName);
+    
+    DataReader* dataRdr  =  dataReader(reactionName);
+    DataReader* bkgndRdr = bkgndReader(reactionName);
+    DataReader* genMCRdr = genMCReader(reactionName);
+    DataReader* accMCRdr = accMCReader(reactionName);
+    
+    if( m_functionality == kFull ){
  
-        // ************************
-        // create a NormIntInterface
-        // ************************
-        
-        // note that in the case that the ATI is being used for plot generation
-        // then the NI's should be obtained from the FitResults object as this
-        // contains the NI cache at the end of the fit
+      // ************************
+      // create a NormIntInterface
+      // ************************
+      
+      // note that in the case that the ATI is being used for plot generation
+      // then the NI's should be obtained from the FitResults object as this
+      // contains the NI cache at the end of the fit
+      
+      NormIntInterface* normInt = NULL;
+      if (genMCRdr && accMCRdr && intenMan && !(reaction->normIntFileInput())){
         
-        NormIntInterface* normInt = NULL;
-        if (genMCRdr && accMCRdr && intenMan && !(reaction->normIntFileInput())){
-          
-          normInt = new NormIntInterface(genMCRdr, accMCRdr, *intenMan);
-          m_normIntMap[reactionName] = normInt;
-          if (reaction->normIntFile() == "")
-            report( WARNING, kModule ) << "no name given to NormInt file for reaction " << reactionName << endl;
-        }
-        else if (reaction->normIntFileInput()){
+        normInt = new NormIntInterface(genMCRdr, accMCRdr, *intenMan);
+        m_normIntMap[reactionName] = normInt;
+        if (reaction->normIntFile() == "")
+          report( WARNING, kModule ) << "no name given to NormInt file for reaction " << reactionName << endl;
+      }
+      else if (reaction->normIntFileInput()){
 
-          normInt = new NormIntInterface(reaction->normIntFile());
-          m_normIntMap[reactionName] = normInt;
-        }
-        else{
+        normInt = new NormIntInterface(reaction->normIntFile());
+        m_normIntMap[reactionName] = normInt;
+      }
+      else{
 
-          report( WARNING, kModule ) << "not creating a NormIntInterface for reaction " << reactionName << endl;
-        }
-        
-        // ************************
-        // create a LikelihoodCalculator
-        // ************************
-        
-        LikelihoodCalculator* likCalc = NULL;
-        if (intenMan && normInt && dataRdr && m_parameterManager){
-          likCalc = new LikelihoodCalculator(*intenMan, *normInt, dataRdr, bkgndRdr, *m_parameterManager);
-          m_likCalcMap[reactionName] = likCalc;
-        }
-        else{
-          report( WARNING, kModule ) << "not creating a LikelihoodCalculator for reaction " << reactionName << endl;
-        }
+        report( WARNING, kModule ) << "not creating a NormIntInterface for reaction " << reactionName << endl;
+      }
+      
+      // ************************
+      // create a LikelihoodCalculator
+      // ************************
+      
+      LikelihoodCalculator* likCalc = NULL;
+      if (intenMan && normInt && dataRdr && m_parameterManager){
+        likCalc = new LikelihoodCalculator(*intenMan, *normInt, dataRdr, bkgndRdr, *m_parameterManager);
+        m_likCalcMap[reactionName] = likCalc;
       }
+      else{
+        report( WARNING, kModule ) << "not creating a LikelihoodCalculator for reaction " << reactionName << endl;
+      }
+    }
+  }
+  
+  if( preload ){
+    
+    for( map< string, LikelihoodCalculator* >::iterator likItr = m_likCalcMap.begin();
+         likItr != m_likCalcMap.end(); ++likItr ){
+      
+      likItr->second->loadData();
     }
+    
+    AmpVecs::releasePreloadedData();
   }
   
   // ************************
@@ -278,7 +320,7 @@ AmpToolsInterface::likelihood() const {
 }
 
 void
-AmpToolsInterface::reinitializePars(){
+AmpToolsInterface::reinitializePars( bool keepFixedTerms ){
   
   // is this fully robust for MPI?  what if it is called on lead only? invalidate will be problematic?
   
@@ -314,6 +356,19 @@ AmpToolsInterface::reinitializePars(){
   // reset parameter steps after reinitializing parameters
   minuitMinimizationManager()->resetErrors();
   
+  // if no term has a free parameter only the production parameters
+  // have changed and the caller may ask to keep the terms
+  if( keepFixedTerms ){
+    
+    bool freeTerms = false;
+    for( unsigned int i = 0; i < m_intensityManagers.size(); ++i ){
+      
+      if( m_intensityManagers[i]->hasTermWithFreeParam() ) freeTerms = true;
+    }
+    
+    if( !freeTerms ) return;
+  }
+  
   // reset flags in AmpVecs which will trigger recalculation of all
   // the terms -- this is necessary for example, in cases where
   // pre-calculated user data depends on parameters that might change
@@ -411,6 +466,12 @@ AmpToolsInterface::finalizeFit( const string& tag ){
   // save normalization integrals
   // ************************
   
+  exportNormIntFiles();
+}
+
+void
+AmpToolsInterface::exportNormIntFiles() const {
+  
   for (unsigned int irct = 0; irct < m_configurationInfo->reactionList().size(); irct++){
     
     ReactionInfo* reaction = m_configurationInfo->reactionList()[irct];
@@ -528,7 +589,11 @@ AmpToolsInterface::clear(){
     for( std::set<DataReader*>::iterator dataReader = m_uniqueDataSets.begin();
         dataReader != m_uniqueDataSets.end(); ++dataReader ){
       
-      if( *dataReader ) delete *dataReader;
+      if( *dataReader && --m_dataReaderUsers[*dataReader] == 0 ){
+        
+        m_dataReaderUsers.erase( *dataReader );
+        delete *dataReader;
+      }
     }
   }
   
@@ -605,9 +670,26 @@ AmpToolsInterface::loadEvent(Kinematics* kin, int iEvent, int nEventsTotal,
 }
 
 
+void
+AmpToolsInterface::adoptEvents(GDouble* pdData, GDouble* pdWeights,
+                               unsigned long long nEvents, unsigned int nParticles,
+                               unsigned int iDataSet){
+  
+  if (iDataSet >= MAXAMPVECS){
+    report( ERROR, kModule ) << "data set index out of range" << endl;
+    assert(false);
+  }
+  
+  clearEvents(iDataSet);
+  
+  m_ampVecs[iDataSet].adoptData(pdData, pdWeights, nEvents, nParticles);
+}
+
+
 double
 AmpToolsInterface::processEvents(string reactionName,
-                                 unsigned int iDataSet) {
+                                 unsigned int iDataSet,
+                                 bool updateTerms) {
   
   if (iDataSet >= MAXAMPVECS){
     report( ERROR, kModule ) << "data set index out of range" << endl;
@@ -622,7 +704,7 @@ AmpToolsInterface::processEvents(string reactionName,
   
   if (isFirstPass) m_ampVecs[iDataSet].allocateTerms(*intenMan,true);
   
-  return intenMan->calcIntensities(m_ampVecs[iDataSet]);
+  return intenMan->calcIntensities(m_ampVecs[iDataSet], updateTerms);
   
 }
 
@@ -903,9 +985,49 @@ AmpToolsInterface::forceUserVarRecalculation( bool state ){
   }
 }
 
+void
+AmpToolsInterface::setRandomStream( unsigned long long seed,
+                                    unsigned long long stream ){
+  
+  m_useRandomStream = true;
+  m_randomStream = CounterRandom( seed, stream );
+}
+
+void
+AmpToolsInterface::setBootstrapReplica( unsigned long long seed,
+                                        unsigned long long replica ){
+  
+  // shouldn't be callin' unless you're fittin'
+  if( m_functionality != kFull ) return;
+  
+  for (unsigned int irct = 0; irct < m_configurationInfo->reactionList().size(); irct++){
+    
+    LikelihoodCalculator* likCalc =
+      likelihoodCalculator( m_configurationInfo->reactionList()[irct]->reactionName() );
+    
+    if( likCalc == NULL ) continue;
+    
+    // substream zero is used by setRandomStream
+    CounterRandom random( seed, replica, irct + 1 );
+    likCalc->resampleData( random );
+  }
+}
+
+void
+AmpToolsInterface::clearBootstrapReplica(){
+  
+  for( map<string,LikelihoodCalculator*>::iterator mapItr = m_likCalcMap.begin();
+      mapItr != m_likCalcMap.end(); ++mapItr ){
+    
+    (*mapItr).second->clearResampling();
+  }
+}
+
 float
 AmpToolsInterface::random( float randMax ) const {
   
+  if( m_useRandomStream ) return m_randomStream.uniform() * randMax;
+  
   return ( (float) rand() / RAND_MAX ) * randMax;
 }
 
@@ -47,6 +47,7 @@
 
 #include "MinuitInterface/MinuitMinimizationManager.h"
 #include "IUAmpTools/IntensityManager.h"
+#include "IUAmpTools/AmplitudeManager.h"
 #include "IUAmpTools/Amplitude.h"
 #include "IUAmpTools/AmpVecs.h"
 #include "IUAmpTools/Neg2LnLikContrib.h"
@@ -57,6 +58,8 @@
 #include "IUAmpTools/ConfigurationInfo.h"
 #include "IUAmpTools/ParameterManager.h"
 #include "IUAmpTools/LikelihoodCalculator.h"
+#include "IUAmpTools/EventLoopThreads.h"
+#include "IUAmpTools/CounterRandom.h"
 
 class FitResults;
 
@@ -131,6 +134,80 @@ public:
   
   static void setRandomSeed( unsigned int seed ) { m_randomSeed = seed; }
   
+  /** Static function to set the number of threads used for the loops over
+   *  events in the calculation of amplitudes, intensities, and integrals.
+   *  In an MPI job this allows one process per node (or socket) to use all
+   *  of the cores on that node.  A value of zero uses all available
+   *  hardware threads.  The default is to use a single thread.
+   *
+   *  \see EventLoopThreads
+   */
+  
+  static void setNumThreads( unsigned int nThreads ) {
+    EventLoopThreads::setNumThreads( nThreads ); }
+  
+  /** Static function to set a directory where binary copies of all data
+   *  sets are stored the first time they are loaded.  Later jobs that
+   *  use data readers with the same identifier map these files rather
+   *  than reading the data through the DataReader.  An empty string
+   *  (the default) disables the cache.
+   *
+   *  \see AmpVecs::setCacheDirectory
+   */
+  
+  static void setDataCacheDirectory( const string& dir ) {
+    AmpVecs::setCacheDirectory( dir ); }
+  
+  /** Static function to set a directory on local disk where the largest
+   *  arrays of four-vectors, user variables, and amplitudes are placed in
+   *  memory-mapped files.  This allows samples larger than the memory of
+   *  the machine to be used, at the cost of speed once the arrays no
+   *  longer fit in memory.  An empty string (the default) disables this.
+   *
+   *  \see AmpVecs::setScratchDirectory
+   */
+  
+  static void setScratchDirectory( const string& dir, unsigned long long minMB = 64 ) {
+    AmpVecs::setScratchDirectory( dir, minMB ); }
+  
+  /** Static function to set a directory where user variables and terms
+   *  that have no free parameters are stored after they are computed.
+   *  Later jobs, or later calls to resetConfigurationInfo, that use the
+   *  same amplitudes on the same data read these rather than computing
+   *  them again.  An empty string (the default) disables the cache.
+   *
+   *  \see AmplitudeManager::setCacheDirectory
+   */
+  
+  static void setAmplitudeCacheDirectory( const string& dir ) {
+    AmplitudeManager::setCacheDirectory( dir ); }
+  
+  /** Static function to write the normalization integral files named in
+   *  the configuration in a binary format, which is much faster to read
+   *  for models with many amplitudes.  Both formats are recognized when
+   *  the files are read.  The default is to write text files.
+   *
+   *  \see NormIntInterface::setBinaryExport
+   */
+  
+  static void setBinaryNormIntFiles( bool binary ) {
+    NormIntInterface::setBinaryExport( binary ); }
+  
+  /** Static function to load all unique data sets concurrently with the
+   *  given number of threads when the interface is set up, rather than
+   *  one at a time on the first likelihood calculation.  The user
+   *  variables and terms for the data are also computed before the fit
+   *  starts.  A value of zero (the default) disables this stage.  Only
+   *  data sets whose DataReader reports that it is thread safe are read
+   *  concurrently, the others are read one at a time.
+   *
+   *  \see AmpVecs::preloadData
+   */
+  
+  static void setPreloadThreads( unsigned int nThreads ) {
+    m_preloadThreads = nThreads; }
+  static unsigned int preloadThreads() { return m_preloadThreads; }
+  
   /** Use this method to re-initialize all IUAmpTools classes based on information
    *  in a new or modified ConfigurationInfo object.
    */
@@ -236,10 +313,13 @@ public:
   /** Reinitialize production and amplitude parameters to the values from
    * ConfigurationInfo.  This is useful for repeated fits where most parameters
    * should be seeded with the same values, for example in a likelihood
-   * scan over a single parameter.
+   * scan over a single parameter.  The terms are recomputed on the next
+   * likelihood calculation unless keepFixedTerms is true and no term has a
+   * free parameter, which is useful when the same terms are fit many
+   * times, e.g., for the replicas of a bootstrap.
    */
   
-  void reinitializePars( );
+  void reinitializePars( bool keepFixedTerms = false );
   
   /** This function will randomly set the production parameters in
    * the likelihood calculator.  It is useful when searching for multiple
@@ -260,6 +340,28 @@ public:
   
   void randomizeParameter( const string& parName, float min = 0, float max = 1 );
   
+  /** By default the randomization functions above use the global rand()
+   *  generator, seeded by setRandomSeed.  This switches this instance to
+   *  its own generator so that several instances can be randomized
+   *  concurrently, and reproducibly, from different threads.  Instances
+   *  with the same seed and different streams produce independent values.
+   */
+  void setRandomStream( unsigned long long seed, unsigned long long stream );
+  
+  /** Resample the signal data and background of all reactions with
+   *  replacement to make replica number replica of a bootstrap.  The same seed and replica
+   *  always give the same sample.  The data are not read again and the
+   *  amplitudes are not recomputed, so many replicas can be fit quickly
+   *  after a single setup.  This is not supported by AmpToolsInterfaceMPI.
+   *
+   *  \see LikelihoodCalculator::resampleData
+   */
+  virtual void setBootstrapReplica( unsigned long long seed, unsigned long long replica );
+  
+  /** Return to fitting the original data after setBootstrapReplica.
+   */
+  void clearBootstrapReplica();
+  
   /** Print final fit results to a file.  The tag can be used to
    *  generate a unique name in the case that multiple results are
    *  written for a singele fit job.
@@ -267,6 +369,18 @@ public:
   
   virtual void finalizeFit( const string& tag = "" );
   
+  /** Write the normalization integral files named in the configuration
+   *  for reactions that do not read them as input, computing the integrals
+   *  if needed.  This is called by finalizeFit, but it can also be used
+   *  without a fit to precompute the integrals:  independent jobs that
+   *  each use a part of the generated and accepted MC can write their own
+   *  files, which are then combined with NormIntInterface::mergeNormIntFiles.
+   *  It must not be used directly in MPI jobs, where the integrals are
+   *  computed collectively in finalizeFit.
+   */
+  
+  void exportNormIntFiles() const;
+  
   
   /** For manual calculations:  clear all events and calculations.
    *  Call this before loading events from a new reaction or to start
@@ -310,12 +424,37 @@ public:
   void loadEvent(Kinematics* kin, int iEvent = 0, int nEventsTotal = 1,
                  unsigned int iDataSet = 0);
   
+  /** For manual calculations:  take ownership of arrays of four-vectors
+   *  and weights that were filled elsewhere, e.g., by a generator.  This
+   *  is an alternative to loadEvent that avoids creating a Kinematics
+   *  object for every event.  The arrays must be allocated with new[] and
+   *  will be deleted when the events are cleared.  Event i, particle j
+   *  starts at pdData[4*nParticles*i+4*j] and is ordered E, px, py, pz.
+   *
+   * \param[in] pdData the four-vectors for all events
+   * \param[in] pdWeights the weights for all events
+   * \param[in] nEvents the number of events
+   * \param[in] nParticles the number of particles in each event
+   * \param[in] iDataSet used to index simultaneous manual calculations
+   *
+   *  \see clearEvents
+   *  \see processEvents
+   *  \see AmpVecs::adoptData
+   */
+  
+  void adoptEvents(GDouble* pdData, GDouble* pdWeights,
+                   unsigned long long nEvents, unsigned int nParticles,
+                   unsigned int iDataSet = 0);
+  
   /** For manual calculations:  perform all calculations on the loaded events.
    *  Load all events (loadEvent or loadEvents) before performing calculations.
    *  Returns the maximum intensity.
    *
    * \param[in] reactionName the name of the reaction that will be calculated
    * \param[in] iDataSet used to index simultaneous manual calculations
+   * \param[in] updateTerms if false, only the intensities are recalculated
+   *  from the amplitudes of the previous call, which is much faster when
+   *  only production parameters have changed
    *
    *  \see clearEvents
    *  \see loadEvent
@@ -323,7 +462,8 @@ public:
    */
   
   double processEvents(string reactionName,
-                       unsigned int iDataSet = 0);
+                       unsigned int iDataSet = 0,
+                       bool updateTerms = true);
   
   
   /** The number of events that have been loaded for manual calculations.
@@ -467,6 +607,11 @@ protected:
   // this makes it easy to avoid a double-delete at cleanup time
   set<DataReader*> m_uniqueDataSets;
   
+  // the user data readers return the same instance for the same arguments,
+  // so several interfaces can hold one reader -- this counts the interfaces
+  // that hold each reader so that it is only deleted by the last one
+  static map<DataReader*,unsigned int> m_dataReaderUsers;
+  
   map<string,NormIntInterface*>     m_normIntMap;
   map<string,LikelihoodCalculator*> m_likCalcMap;
   
@@ -475,6 +620,7 @@ protected:
   static vector<DataReader*> m_userDataReaders;
   
   static unsigned int m_randomSeed;
+  static unsigned int m_preloadThreads;
   
   // these variables are used in cases where the AmpToolsInterface
   // must provide a place to load the data -- during normal
@@ -486,6 +632,9 @@ protected:
   
   FitResults* m_fitResults;
   
+  bool m_useRandomStream;
+  mutable CounterRandom m_randomStream;
+  
   float random( float randMax ) const;
   
 private:
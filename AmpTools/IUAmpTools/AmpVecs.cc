@@ -34,16 +34,129 @@
 // any other party arising from use of the program.
 //******************************************************************************
 
+#include <algorithm>
 #include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+#include <sys/stat.h>
 
 #include "IUAmpTools/AmpVecs.h"
 #include "IUAmpTools/IntensityManager.h"
 #include "IUAmpTools/DataReader.h"
 #include "IUAmpTools/Kinematics.h"
+#include "IUAmpTools/MappedFile.h"
 
 #include "IUAmpTools/report.h"
 const char* AmpVecs::kModule = "AmpVecs";
 
+string AmpVecs::m_cacheDirectory = "";
+map< string, MappedFile* > AmpVecs::m_mappedFiles;
+map< string, AmpVecs* > AmpVecs::m_preloadedData;
+string AmpVecs::m_scratchDirectory = "";
+unsigned long long AmpVecs::m_scratchMinBytes = 0;
+map< const GDouble*, MappedFile* > AmpVecs::m_scratchArrays;
+
+// data sets may be loaded concurrently by preloadData so access to
+// the list of mapped files needs to be serialized
+static mutex mappedFilesMutex;
+static mutex scratchArraysMutex;
+
+// The binary cache file starts with this header, which is followed by
+// the cache identifier of the data reader (padded to a multiple of eight
+// bytes), m_iNEvents weights, and the four-vectors in the layout of
+// m_pdData.  Values are stored in native byte order.
+
+struct AmpVecsCacheHeader {
+  
+  char magic[8];
+  unsigned int version;
+  unsigned int bytesPerValue;
+  unsigned long long nTrueEvents;
+  unsigned long long nEvents;
+  unsigned long long nParticles;
+  unsigned long long sourceStamp;
+  unsigned long long idLength;
+};
+
+static const char kCacheMagic[8] = { 'A', 'M', 'P', 'V', 'E', 'C', 'S', '\0' };
+static const unsigned int kCacheVersion = 2;
+
+// a hash of the names, sizes, and modification times of the source
+// files of the data reader, which is stored in the cache header so that
+// a cache file is replaced when its source changes
+
+static unsigned long long
+cacheSourceStamp( DataReader* pDataReader ){
+  
+  ostringstream stamp;
+  
+  vector< string > files = pDataReader->sourceFiles();
+  for( vector< string >::const_iterator file = files.begin();
+      file != files.end(); ++file ){
+    
+    struct stat fileStat;
+    if( stat( file->c_str(), &fileStat ) != 0 ) continue;
+    
+    stamp << *file << " " << fileStat.st_size << " "
+          << fileStat.st_mtime << "\n";
+  }
+  
+  string str = stamp.str();
+  
+  unsigned long long hash = 14695981039346656037ULL;
+  for( string::const_iterator c = str.begin(); c != str.end(); ++c ){
+    
+    hash ^= static_cast< unsigned char >( *c );
+    hash *= 1099511628211ULL;
+  }
+  
+  return hash;
+}
+
+// check that a cache file holds the data that the reader would provide
+
+static bool
+cacheFileMatches( const MappedFile* file, const string& id,
+                  unsigned long long sourceStamp,
+                  unsigned long long nTrueEvents, unsigned long long nEvents ){
+  
+  unsigned long long idBytes = 8 * ( ( id.size() + 7 ) / 8 );
+  
+  const AmpVecsCacheHeader* header =
+    reinterpret_cast< const AmpVecsCacheHeader* >( file->data() );
+  
+  bool valid = ( file->size() >= sizeof( AmpVecsCacheHeader ) );
+  
+  valid = valid &&
+    ( memcmp( header->magic, kCacheMagic, sizeof( kCacheMagic ) ) == 0 ) &&
+    ( header->version == kCacheVersion ) &&
+    ( header->bytesPerValue == sizeof( GDouble ) ) &&
+    ( header->nTrueEvents == nTrueEvents ) &&
+    ( header->nEvents == nEvents ) &&
+    ( header->nParticles > 0 ) &&
+    ( header->sourceStamp == sourceStamp ) &&
+    ( header->idLength == id.size() );
+  
+  valid = valid &&
+    ( file->size() == sizeof( AmpVecsCacheHeader ) + idBytes +
+      ( 4 * header->nParticles + 1 ) * nEvents * sizeof( GDouble ) );
+  
+  valid = valid &&
+    ( id.compare( 0, string::npos, file->data() + sizeof( AmpVecsCacheHeader ),
+                  id.size() ) == 0 );
+  
+  return valid;
+}
+
 #ifdef GPU_ACCELERATION
 #include "GPUManager/GPUManager.h"
 #include "cuda_runtime.h"
@@ -61,6 +174,7 @@ AmpVecs::AmpVecs(){
   
   m_pdData      = 0 ;
   m_pdWeights   = 0 ;
+  m_pdMultiplicity = 0 ;
   
   m_pdAmps       = 0 ;
   m_pdAmpFactors = 0 ;
@@ -74,6 +188,10 @@ AmpVecs::AmpVecs(){
   m_dataLoaded     = false;
   m_usesSharedData = false;
   m_sharedDataHost = NULL;
+  m_externalData = false;
+  m_usesSharedUserVars = false;
+  m_dataHash = 0;
+  m_cacheable = true;
     
   m_hasNonUnityWeights = false;
   m_hasMixedSignWeights = false;
@@ -95,6 +213,7 @@ AmpVecs::deallocAmpVecs()
   m_termsValid    = false ;
   m_integralValid = false ;
   m_dataLoaded    = false ;
+  m_dataHash = 0;
 
   m_hasNonUnityWeights = false;
   m_hasMixedSignWeights = false;
@@ -109,6 +228,10 @@ AmpVecs::deallocAmpVecs()
     delete[] m_pdWeights;
   m_pdWeights=0;
   
+  if(m_pdMultiplicity)
+    delete[] m_pdMultiplicity;
+  m_pdMultiplicity=0;
+  
   if(m_pdIntensity)
     delete[] m_pdIntensity;
   m_pdIntensity=0; 
@@ -117,20 +240,21 @@ AmpVecs::deallocAmpVecs()
     delete[] m_pdIntegralMatrix;
   m_pdIntegralMatrix=0;
 
-  if(m_pdUserVars)
-    delete[] m_pdUserVars;
+  if(m_pdUserVars && !m_usesSharedUserVars)
+    freeArray(m_pdUserVars);
   m_pdUserVars=0;
+  m_usesSharedUserVars = false;
   
   m_userVarsOffset.clear();
   
 #ifndef GPU_ACCELERATION
   
   if(m_pdAmps)
-    delete[] m_pdAmps;
+    freeArray(m_pdAmps);
   m_pdAmps=0;
   
   if(m_pdAmpFactors)
-    delete[] m_pdAmpFactors;
+    freeArray(m_pdAmpFactors);
   m_pdAmpFactors=0;
 
 #else
@@ -191,10 +315,11 @@ AmpVecs::clearFourVecs(){
   }
 
   // proceed as normal by flushing the four-vectors
-  if(m_pdData)
-    delete[] m_pdData;
+  if(m_pdData && !m_externalData)
+    freeArray(m_pdData);
 
   m_pdData=0;
+  m_externalData = false;
 }
 
 void
@@ -216,7 +341,7 @@ AmpVecs::loadEvent( const Kinematics* pKinematics, unsigned long long iEvent,
     m_iNParticles = pKinematics->particleList().size();
     assert(m_iNParticles);
     
-    m_pdData = new GDouble[4*m_iNParticles*m_iNEvents];
+    m_pdData = allocateArray( 4*m_iNParticles*m_iNEvents );
     m_pdWeights = new GDouble[m_iNEvents];
   }
   
@@ -236,6 +361,7 @@ AmpVecs::loadEvent( const Kinematics* pKinematics, unsigned long long iEvent,
   m_integralValid = false;
   m_dataLoaded = true;
   m_userVarsOffset.clear();
+  m_dataHash = 0;
 }
 
 
@@ -251,9 +377,22 @@ AmpVecs::loadData( DataReader* pDataReader ){
   
   // Get the number of events and reset the data reader
   
+  // if the data set has been preloaded then just share it
+  
+  map< string, AmpVecs* >::iterator preItr =
+    m_preloadedData.find( pDataReader->cacheIdentifier() );
+  if( preItr != m_preloadedData.end() && preItr->second != this ){
+    
+    preItr->second->shareDataWith( this );
+    return;
+  }
+  
   pDataReader->resetSource();
   m_iNTrueEvents = pDataReader->numEvents();
 
+  if( !m_cacheDirectory.empty() && m_iNTrueEvents > 0 &&
+      loadFromCache( pDataReader ) ) return;
+
   // try to print an informative message -- this can be normal behavior in
   // an MPI job with a sparse background source and many concurrent processess
   if( m_iNTrueEvents < 1 ){
@@ -269,6 +408,16 @@ AmpVecs::loadData( DataReader* pDataReader ){
     report( NOTICE, kModule ) << "\n does not contain any events." << endl;
   }
   
+  // Use the bulk interface of the data reader if it exists
+
+  if( pDataReader->hasBulkRead() && m_iNTrueEvents > 0 ){
+    
+    loadBulkData( pDataReader );
+    
+    if( !m_cacheDirectory.empty() ) writeToCache( pDataReader );
+    return;
+  }
+  
   // Loop over events and load each one individually
   
   Kinematics* pKinematics;
@@ -276,16 +425,7 @@ AmpVecs::loadData( DataReader* pDataReader ){
     pKinematics = pDataReader->getEvent();
     loadEvent(pKinematics, iEvent, m_iNTrueEvents );
 
-    float weight = pKinematics->weight();
-    
-    // fill some booleans that contain collective information about the weights
-    if( weight != 1 ) m_hasNonUnityWeights = true;
-    if( m_lastWeightSign == 0 ) m_lastWeightSign = weight;
-    int thisWeightSign = ( weight > 0 ? 1 : 0 );
-    thisWeightSign = ( weight < 0 ? -1 : thisWeightSign );
-    if( thisWeightSign * m_lastWeightSign < 0 ) m_hasMixedSignWeights = true;
-    m_lastWeightSign = thisWeightSign;
-
+    updateWeightInfo( pKinematics->weight() );
     m_dSumWeights += pKinematics->weight();
     if (iEvent < (m_iNTrueEvents - 1)) delete pKinematics;
   }
@@ -303,6 +443,566 @@ AmpVecs::loadData( DataReader* pDataReader ){
   m_integralValid = false;
   m_dataLoaded = true;
   m_userVarsOffset.clear();
+  
+  if( !m_cacheDirectory.empty() && m_iNTrueEvents > 0 )
+    writeToCache( pDataReader );
+}
+
+void
+AmpVecs::preloadData( const set< DataReader* >& readers, unsigned int nThreads ){
+  
+  vector< DataReader* > toLoad;
+  vector< string > toLoadId;
+  for( set< DataReader* >::const_iterator rdr = readers.begin();
+       rdr != readers.end(); ++rdr ){
+    
+    if( *rdr == NULL ) continue;
+    
+    string id = (**rdr).cacheIdentifier();
+    if( m_preloadedData.find( id ) != m_preloadedData.end() ||
+        find( toLoadId.begin(), toLoadId.end(), id ) != toLoadId.end() )
+      continue;
+    
+    toLoad.push_back( *rdr );
+    toLoadId.push_back( id );
+  }
+  
+  if( toLoad.empty() ) return;
+  
+  // create all of the objects up front so that the map is not
+  // modified while the worker threads are running
+  vector< AmpVecs* > ampVecs( toLoad.size() );
+  for( unsigned int i = 0; i < toLoad.size(); ++i ){
+    
+    ampVecs[i] = new AmpVecs;
+  }
+  
+  // readers that can't be used from several threads at once are
+  // read one at a time before any threads are started
+  vector< unsigned int > concurrent;
+  for( unsigned int i = 0; i < toLoad.size(); ++i ){
+    
+    if( toLoad[i]->isThreadSafe() ) concurrent.push_back( i );
+  }
+  
+  if( nThreads == 0 ) nThreads = thread::hardware_concurrency();
+  if( nThreads == 0 ) nThreads = 1;
+  if( nThreads > concurrent.size() ) nThreads = concurrent.size();
+  if( nThreads == 0 ) nThreads = 1;
+  
+  report( INFO, kModule ) << "Loading " << toLoad.size() << " data sets, "
+  << concurrent.size() << " of them using " << nThreads << " threads..." << endl;
+  
+  for( unsigned int i = 0; i < toLoad.size(); ++i ){
+    
+    if( !toLoad[i]->isThreadSafe() ) ampVecs[i]->loadData( toLoad[i] );
+  }
+  
+  // each thread takes the next data set that has not been started
+  atomic< unsigned int > next( 0 );
+  
+  auto worker = [&](){
+    
+    for( unsigned int k = next++; k < concurrent.size(); k = next++ ){
+      
+      ampVecs[concurrent[k]]->loadData( toLoad[concurrent[k]] );
+    }
+  };
+  
+  vector< thread > workers;
+  for( unsigned int i = 1; i < nThreads; ++i ){
+    
+    workers.push_back( thread( worker ) );
+  }
+  
+  worker();
+  
+  for( vector< thread >::iterator thr = workers.begin();
+       thr != workers.end(); ++thr ){
+    
+    thr->join();
+  }
+  
+  for( unsigned int i = 0; i < toLoad.size(); ++i ){
+    
+    m_preloadedData[toLoadId[i]] = ampVecs[i];
+  }
+  
+  report( INFO, kModule ) << "\tDone." << endl;
+}
+
+void
+AmpVecs::releasePreloadedData(){
+  
+  // deleting the host hands the four-vectors to objects that share them
+  for( map< string, AmpVecs* >::iterator preItr = m_preloadedData.begin();
+       preItr != m_preloadedData.end(); ++preItr ){
+    
+    delete preItr->second;
+  }
+  
+  m_preloadedData.clear();
+}
+
+void
+AmpVecs::setScratchDirectory( const string& dir, unsigned long long minMB ){
+  
+  m_scratchDirectory = dir;
+  m_scratchMinBytes = minMB * 1024 * 1024;
+}
+
+GDouble*
+AmpVecs::allocateArray( unsigned long long size ){
+  
+  unsigned long long bytes = size * sizeof( GDouble );
+  
+  if( m_scratchDirectory.empty() || bytes < m_scratchMinBytes || bytes == 0 )
+    return new GDouble[size];
+  
+  MappedFile* file = new MappedFile( m_scratchDirectory, bytes );
+  
+  if( !file->isValid() ){
+    
+    report( WARNING, kModule ) << "Unable to allocate " << bytes / ( 1024 * 1024 )
+    << " MB in scratch directory " << m_scratchDirectory
+    << ", using memory instead." << endl;
+    
+    delete file;
+    return new GDouble[size];
+  }
+  
+  GDouble* array = reinterpret_cast< GDouble* >( file->data() );
+  
+  lock_guard< mutex > lock( scratchArraysMutex );
+  m_scratchArrays[array] = file;
+  
+  return array;
+}
+
+void
+AmpVecs::freeArray( GDouble* array ){
+  
+  {
+    lock_guard< mutex > lock( scratchArraysMutex );
+    
+    map< const GDouble*, MappedFile* >::iterator fileItr = m_scratchArrays.find( array );
+    if( fileItr != m_scratchArrays.end() ){
+      
+      delete fileItr->second;
+      m_scratchArrays.erase( fileItr );
+      return;
+    }
+  }
+  
+  delete[] array;
+}
+
+void
+AmpVecs::loadBulkData( DataReader* pDataReader ){
+  
+  m_iNParticles = pDataReader->numParticles();
+  assert( m_iNParticles );
+  
+  m_iNEvents = m_iNTrueEvents;
+#ifdef GPU_ACCELERATION
+  m_iNEvents = GPUManager::calcNEventsGPU( m_iNTrueEvents );
+#endif
+  
+  m_pdData = allocateArray( 4*m_iNParticles*m_iNEvents );
+  m_pdWeights = new GDouble[m_iNEvents];
+  
+  unsigned long long iEvent = 0;
+  while( iEvent < m_iNTrueEvents ){
+    
+    unsigned long long nRead =
+      pDataReader->readEvents( m_pdData + 4*m_iNParticles*iEvent,
+                               m_pdWeights + iEvent,
+                               m_iNTrueEvents - iEvent );
+    
+    if( nRead == 0 ){
+      
+      report( ERROR, kModule ) << pDataReader->name() << " provided " << iEvent
+      << " events but reported " << m_iNTrueEvents << " events." << endl;
+      assert( false );
+    }
+    
+    iEvent += nRead;
+  }
+  
+  finishArrayLoad();
+}
+
+unsigned long long
+AmpVecs::loadNextEvents( DataReader* pDataReader, unsigned long long maxEvents ){
+  
+  if( m_pdData!=0 || m_pdWeights!=0 ){
+    report( ERROR, kModule ) << "Trying to load data into a non-empty AmpVecs object\n"<<flush;
+    assert(false);
+  }
+  
+  if( maxEvents == 0 ) return 0;
+  
+  GDouble* pdData = NULL;
+  GDouble* pdWeights = new GDouble[maxEvents];
+  unsigned int iNParticles = 0;
+  unsigned long long iEvent = 0;
+  
+  if( pDataReader->hasBulkRead() ){
+    
+    iNParticles = pDataReader->numParticles();
+    assert( iNParticles );
+    
+    pdData = new GDouble[4*iNParticles*maxEvents];
+    
+    while( iEvent < maxEvents ){
+      
+      unsigned long long nRead =
+        pDataReader->readEvents( pdData + 4*iNParticles*iEvent,
+                                 pdWeights + iEvent, maxEvents - iEvent );
+      
+      if( nRead == 0 ) break;
+      iEvent += nRead;
+    }
+  }
+  else{
+    
+    Kinematics* pKinematics;
+    while( iEvent < maxEvents &&
+           ( pKinematics = pDataReader->getEvent() ) != NULL ){
+      
+      if( pdData == NULL ){
+        
+        iNParticles = pKinematics->particleList().size();
+        assert( iNParticles );
+        
+        pdData = new GDouble[4*iNParticles*maxEvents];
+      }
+      
+      for( unsigned int iParticle = 0; iParticle < iNParticles; iParticle++ ){
+        pdData[4*iEvent*iNParticles+4*iParticle+0]=pKinematics->particle(iParticle).E();
+        pdData[4*iEvent*iNParticles+4*iParticle+1]=pKinematics->particle(iParticle).Px();
+        pdData[4*iEvent*iNParticles+4*iParticle+2]=pKinematics->particle(iParticle).Py();
+        pdData[4*iEvent*iNParticles+4*iParticle+3]=pKinematics->particle(iParticle).Pz();
+      }
+      
+      pdWeights[iEvent] = pKinematics->weight();
+      
+      delete pKinematics;
+      ++iEvent;
+    }
+  }
+  
+  if( iEvent == 0 ){
+    
+    delete[] pdData;
+    delete[] pdWeights;
+    return 0;
+  }
+  
+  adoptData( pdData, pdWeights, iEvent, iNParticles );
+  
+  return iEvent;
+}
+
+void
+AmpVecs::adoptData( GDouble* pdData, GDouble* pdWeights,
+                    unsigned long long iNTrueEvents, unsigned int iNParticles ){
+  
+  if( m_pdData!=0 || m_pdWeights!=0 ){
+    report( ERROR, kModule ) << "Trying to load data into a non-empty AmpVecs object\n"<<flush;
+    assert(false);
+  }
+  
+  assert( iNParticles );
+  
+  m_iNTrueEvents = iNTrueEvents;
+  m_iNEvents = iNTrueEvents;
+  m_iNParticles = iNParticles;
+  
+  m_pdData = pdData;
+  m_pdWeights = pdWeights;
+  
+#ifdef GPU_ACCELERATION
+  m_iNEvents = GPUManager::calcNEventsGPU( iNTrueEvents );
+  
+  if( m_iNEvents != m_iNTrueEvents ){
+    
+    m_pdData = allocateArray( 4*m_iNParticles*m_iNEvents );
+    m_pdWeights = new GDouble[m_iNEvents];
+    
+    memcpy( m_pdData, pdData, 4*m_iNParticles*m_iNTrueEvents*sizeof( GDouble ) );
+    memcpy( m_pdWeights, pdWeights, m_iNTrueEvents*sizeof( GDouble ) );
+    
+    delete[] pdData;
+    delete[] pdWeights;
+  }
+#endif
+  
+  finishArrayLoad();
+}
+
+void
+AmpVecs::finishArrayLoad(){
+  
+  // this completes the loading of data when the arrays of four-vectors
+  // and weights have been filled for the true events
+  
+  for( unsigned long long iEvent = 0; iEvent < m_iNTrueEvents; ++iEvent ){
+    
+    updateWeightInfo( m_pdWeights[iEvent] );
+    m_dSumWeights += m_pdWeights[iEvent];
+  }
+  
+  // fill any remaining space in the data array with the last event
+  
+  if( m_iNTrueEvents > 0 ){
+    
+    unsigned long long iLast = m_iNTrueEvents - 1;
+    
+    for( unsigned long long iEvent = m_iNTrueEvents; iEvent < m_iNEvents; ++iEvent ){
+      
+      memcpy( m_pdData + 4*m_iNParticles*iEvent, m_pdData + 4*m_iNParticles*iLast,
+              4*m_iNParticles*sizeof( GDouble ) );
+      m_pdWeights[iEvent] = m_pdWeights[iLast];
+    }
+  }
+  
+  m_termsValid = false;
+  m_integralValid = false;
+  m_dataLoaded = true;
+  m_userVarsOffset.clear();
+  m_dataHash = 0;
+}
+
+void
+AmpVecs::updateWeightInfo( float weight ){
+  
+  // fill some booleans that contain collective information about the weights
+  if( weight != 1 ) m_hasNonUnityWeights = true;
+  if( m_lastWeightSign == 0 ) m_lastWeightSign = weight;
+  int thisWeightSign = ( weight > 0 ? 1 : 0 );
+  thisWeightSign = ( weight < 0 ? -1 : thisWeightSign );
+  if( thisWeightSign * m_lastWeightSign < 0 ) m_hasMixedSignWeights = true;
+  m_lastWeightSign = thisWeightSign;
+}
+
+unsigned long long
+AmpVecs::dataHash(){
+  
+  if( !m_cacheable ) return 0;
+  if( m_dataHash != 0 || m_pdData == NULL ) return m_dataHash;
+  
+  // an FNV-1a style hash that mixes one 64-bit word at a time, which
+  // is fast enough to be used on large data sets
+  unsigned long long hash = 14695981039346656037ULL;
+  
+  hash ^= m_iNEvents;
+  hash *= 1099511628211ULL;
+  hash ^= m_iNParticles;
+  hash *= 1099511628211ULL;
+  
+  unsigned long long nBytes = 4 * m_iNParticles * m_iNEvents * sizeof( GDouble );
+  const unsigned char* bytes = reinterpret_cast< const unsigned char* >( m_pdData );
+  
+  for( unsigned long long i = 0; i < nBytes; i += sizeof( unsigned long long ) ){
+    
+    unsigned long long word = 0;
+    memcpy( &word, bytes + i,
+            ( nBytes - i < sizeof( word ) ? nBytes - i : sizeof( word ) ) );
+    
+    hash ^= word;
+    hash *= 1099511628211ULL;
+  }
+  
+  // reserve zero to mean the hash is not available
+  m_dataHash = ( hash == 0 ? 1 : hash );
+  
+  return m_dataHash;
+}
+
+string
+AmpVecs::cacheFileName( DataReader* pDataReader ){
+  
+  // the identifier can contain any characters so use a hash of
+  // it for the file name -- the full identifier is stored in the
+  // file and checked when it is loaded
+  string id = pDataReader->cacheIdentifier();
+  
+  unsigned long long hash = 14695981039346656037ULL;
+  for( string::const_iterator c = id.begin(); c != id.end(); ++c ){
+    
+    hash ^= static_cast< unsigned char >( *c );
+    hash *= 1099511628211ULL;
+  }
+  
+  ostringstream fileName;
+  fileName << m_cacheDirectory << "/" << pDataReader->name() << "_"
+           << hex << setw( 16 ) << setfill( '0' ) << hash << ".avc";
+  
+  return fileName.str();
+}
+
+bool
+AmpVecs::hasValidCache( DataReader* pDataReader ){
+  
+  if( m_cacheDirectory.empty() ) return false;
+  
+  unsigned long long nTrueEvents = pDataReader->numEvents();
+  unsigned long long nEvents = nTrueEvents;
+#ifdef GPU_ACCELERATION
+  nEvents = GPUManager::calcNEventsGPU( nTrueEvents );
+#endif
+  
+  MappedFile file( cacheFileName( pDataReader ) );
+  
+  return file.isValid() &&
+    cacheFileMatches( &file, pDataReader->cacheIdentifier(),
+                      cacheSourceStamp( pDataReader ), nTrueEvents, nEvents );
+}
+
+bool
+AmpVecs::loadFromCache( DataReader* pDataReader ){
+  
+  string fileName = cacheFileName( pDataReader );
+  
+  lock_guard< mutex > lock( mappedFilesMutex );
+  
+  MappedFile* file = NULL;
+  bool newFile = false;
+  
+  map< string, MappedFile* >::iterator fileItr = m_mappedFiles.find( fileName );
+  if( fileItr != m_mappedFiles.end() ){
+    
+    file = fileItr->second;
+  }
+  else{
+    
+    file = new MappedFile( fileName );
+    
+    if( !file->isValid() ){
+      
+      delete file;
+      return false;
+    }
+    
+    m_mappedFiles[fileName] = file;
+    newFile = true;
+  }
+  
+  unsigned long long nEvents = m_iNTrueEvents;
+#ifdef GPU_ACCELERATION
+  nEvents = GPUManager::calcNEventsGPU( m_iNTrueEvents );
+#endif
+  
+  string id = pDataReader->cacheIdentifier();
+  unsigned long long idBytes = 8 * ( ( id.size() + 7 ) / 8 );
+  
+  const AmpVecsCacheHeader* header =
+    reinterpret_cast< const AmpVecsCacheHeader* >( file->data() );
+  
+  if( !cacheFileMatches( file, id, cacheSourceStamp( pDataReader ),
+                         m_iNTrueEvents, nEvents ) ){
+    
+    report( NOTICE, kModule ) << "Cache file " << fileName
+    << " does not match the data reader and will be replaced." << endl;
+    
+    // a mapping that was already in the list may be in use elsewhere
+    if( newFile ){
+      
+      m_mappedFiles.erase( fileName );
+      delete file;
+    }
+    
+    return false;
+  }
+  
+  report( INFO, kModule ) << "Loading " << m_iNTrueEvents << " events from cache file "
+  << fileName << endl;
+  
+  m_iNEvents = nEvents;
+  m_iNParticles = header->nParticles;
+  
+  const GDouble* weights = reinterpret_cast< const GDouble* >
+    ( file->data() + sizeof( AmpVecsCacheHeader ) + idBytes );
+  
+  // the weights are copied since other objects that share the data
+  // receive their own copy of the weights, see shareDataWith
+  m_pdWeights = new GDouble[m_iNEvents];
+  memcpy( m_pdWeights, weights, m_iNEvents * sizeof( GDouble ) );
+  
+  for( unsigned long long iEvent = 0; iEvent < m_iNTrueEvents; ++iEvent ){
+    
+    updateWeightInfo( m_pdWeights[iEvent] );
+    m_dSumWeights += m_pdWeights[iEvent];
+  }
+  
+  // the mapped file is read-only and the four-vectors are never
+  // modified after they are loaded so they can be used in place
+  m_pdData = const_cast< GDouble* >( weights + m_iNEvents );
+  m_externalData = true;
+  
+  m_termsValid = false;
+  m_integralValid = false;
+  m_dataLoaded = true;
+  m_userVarsOffset.clear();
+  m_dataHash = 0;
+  
+  return true;
+}
+
+void
+AmpVecs::writeToCache( DataReader* pDataReader ) const {
+  
+  string fileName = cacheFileName( pDataReader );
+  
+  // write to a temporary file and rename it so that other jobs never
+  // see a partially written file
+  ostringstream tmpName;
+  tmpName << fileName << ".tmp" << getpid() << "." << this;
+  
+  ofstream outFile( tmpName.str().c_str(), ios::binary );
+  
+  if( !outFile ){
+    
+    report( WARNING, kModule ) << "Unable to write cache file " << tmpName.str() << endl;
+    return;
+  }
+  
+  string id = pDataReader->cacheIdentifier();
+  
+  AmpVecsCacheHeader header;
+  memcpy( header.magic, kCacheMagic, sizeof( kCacheMagic ) );
+  header.version = kCacheVersion;
+  header.bytesPerValue = sizeof( GDouble );
+  header.nTrueEvents = m_iNTrueEvents;
+  header.nEvents = m_iNEvents;
+  header.nParticles = m_iNParticles;
+  header.sourceStamp = cacheSourceStamp( pDataReader );
+  header.idLength = id.size();
+  
+  outFile.write( reinterpret_cast< const char* >( &header ), sizeof( header ) );
+  
+  // pad the identifier so the arrays are aligned
+  string paddedId = id;
+  paddedId.resize( 8 * ( ( id.size() + 7 ) / 8 ), '\0' );
+  outFile.write( paddedId.c_str(), paddedId.size() );
+  
+  outFile.write( reinterpret_cast< const char* >( m_pdWeights ),
+                 m_iNEvents * sizeof( GDouble ) );
+  outFile.write( reinterpret_cast< const char* >( m_pdData ),
+                 4 * m_iNParticles * m_iNEvents * sizeof( GDouble ) );
+  
+  outFile.close();
+  
+  if( !outFile || rename( tmpName.str().c_str(), fileName.c_str() ) != 0 ){
+    
+    report( WARNING, kModule ) << "Unable to write cache file " << fileName << endl;
+    remove( tmpName.str().c_str() );
+    return;
+  }
+  
+  report( INFO, kModule ) << "Wrote " << m_iNTrueEvents << " events to cache file "
+  << fileName << endl;
 }
 
 
@@ -341,13 +1041,13 @@ AmpVecs::allocateTerms( const IntensityManager& intenMan, bool bAllocIntensity )
     // in order to ensure backwards compatibility with older
     // amplitude definitions
     
-    m_pdUserVars = new GDouble[m_iNEvents * m_userVarsPerEvent];
+    m_pdUserVars = allocateArray( m_iNEvents * m_userVarsPerEvent );
   }
   
 #ifndef GPU_ACCELERATION
   
-  m_pdAmps = new GDouble[m_iNEvents * intenMan.termStoragePerEvent()];
-  m_pdAmpFactors = new GDouble[m_iNEvents * m_maxFactPerEvent];
+  m_pdAmps = allocateArray( m_iNEvents * intenMan.termStoragePerEvent() );
+  m_pdAmpFactors = allocateArray( m_iNEvents * m_maxFactPerEvent );
   
 #else
   
@@ -422,6 +1122,7 @@ AmpVecs::shareDataWith( AmpVecs* targetAmpVecs ){
   targetAmpVecs->m_iNParticles = m_iNParticles;
   
   targetAmpVecs->m_pdData = m_pdData;
+  targetAmpVecs->m_externalData = m_externalData;
 
   // while we are really going to share the four-vectors,
   // we will give the target a copy of the weights -- this
@@ -462,3 +1163,54 @@ AmpVecs::claimDataOwnership( set< AmpVecs* > sharedFriends ){
     (*avItr)->m_sharedDataHost = this;
   }
 }
+
+void
+AmpVecs::adoptExternalFourVecs( GDouble* pdData ){
+  
+  // only the host of the data can swap it out since it
+  // needs to update the pointers of the friends
+  assert( !m_usesSharedData );
+  assert( pdData != NULL );
+  
+  if( m_pdData && !m_externalData )
+    freeArray( m_pdData );
+  
+  m_pdData = pdData;
+  m_externalData = true;
+  
+  for( set< AmpVecs* >::iterator avItr = m_sharedDataFriends.begin();
+       avItr != m_sharedDataFriends.end(); ++avItr ){
+    
+    (*avItr)->m_pdData = pdData;
+    (*avItr)->m_externalData = true;
+  }
+}
+
+void
+AmpVecs::shareUserVars( const AmpVecs& source ){
+  
+#ifdef GPU_ACCELERATION
+  
+  // the user variables also live on the GPU
+  report( ERROR, kModule ) << "Sharing of user variables is not supported "
+  << "with GPU acceleration." << endl;
+  assert( false );
+#endif
+  
+  // the source must hold the same events and must have computed
+  // the variables already
+  assert( source.m_iNEvents == m_iNEvents );
+  assert( source.m_userVarsPerEvent == m_userVarsPerEvent );
+  assert( source.m_termsValid );
+  
+  if( m_userVarsPerEvent == 0 ) return;
+  
+  if( m_pdUserVars && !m_usesSharedUserVars )
+    freeArray( m_pdUserVars );
+  
+  m_pdUserVars = source.m_pdUserVars;
+  m_usesSharedUserVars = true;
+  
+  // with the offsets of the source the variables are not computed again
+  m_userVarsOffset = source.m_userVarsOffset;
+}
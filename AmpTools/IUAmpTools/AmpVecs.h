@@ -41,6 +41,7 @@
 
 #include <map>
 #include <set>
+#include <vector>
 #include <string>
 
 #ifdef GPU_ACCELERATION
@@ -52,6 +53,7 @@ using namespace std;
 class DataReader;
 class IntensityManager;
 class Kinematics;
+class MappedFile;
 
 /**
  * This class is intended to be a helper structure that serves as a place
@@ -122,6 +124,16 @@ struct AmpVecs
    */
   GDouble* m_pdWeights;
   
+  /**
+   * An optional array of length iNEvents that multiplies the contribution
+   * of each event to the sum of the log of the intensity, e.g., to resample
+   * the data for a bootstrap.  It is NULL if each event is used once.  It
+   * is owned by this object and is not shared with other objects.
+   *
+   * \see LikelihoodCalculator::resampleData
+   */
+  GDouble* m_pdMultiplicity;
+  
   /**
    * An array of length 2 * iNAmps * iNEvents that stores the real and imaginary
    * parts of the complete decay amplitude (product of factors) for each event.
@@ -183,6 +195,22 @@ struct AmpVecs
    * to the data set so it resides in the AmpVecs struct.
    */
   map< string, unsigned long long > m_userVarsOffset;
+  
+  /**
+   * This returns a hash of the four-vectors that can be used to identify
+   * the data set.  It is computed on the first call after the data are
+   * loaded and is zero if the four-vectors are not available or if
+   * m_cacheable is false.
+   */
+  unsigned long long dataHash();
+  
+  /**
+   * A boolean that can be set to false to prevent results computed for
+   * this data set from being read from or written to the cache directory,
+   * e.g., for scratch storage that is reloaded with a few events for
+   * every calculation.  It is true by default.
+   */
+  bool m_cacheable;
 
   /**
    * These booleans track features of the set of weights are are adjusted
@@ -257,6 +285,85 @@ struct AmpVecs
    */
   void loadData( DataReader* pDataReader );
   
+  /**
+   * This sets a directory for a cache of data sets.  If the directory is
+   * set, loadData will write the weights and four-vectors to a binary file
+   * in the directory the first time a data set is loaded, and subsequent
+   * calls to loadData (in this or other jobs) with a data reader that has
+   * the same cache identifier will map the file rather than reading the
+   * data.  The four-vectors are used directly from the mapped file.
+   *
+   * The file is checked against the number of events reported by the
+   * data reader and against the sizes and modification times of the
+   * files returned by DataReader::sourceFiles, and it is replaced if
+   * any of these have changed.
+   *
+   * \param[in] dir the directory to use, empty to disable the cache
+   *
+   * \see DataReader::cacheIdentifier
+   * \see DataReader::sourceFiles
+   */
+  static void setCacheDirectory( const string& dir ) { m_cacheDirectory = dir; }
+  static const string& cacheDirectory() { return m_cacheDirectory; }
+  
+  /**
+   * This returns true if the cache directory holds a file that loadData
+   * would use for the data reader instead of reading the source.
+   *
+   * \param[in] pDataReader a pointer to a user-defined data reader
+   *
+   * \see setCacheDirectory
+   */
+  static bool hasValidCache( DataReader* pDataReader );
+  
+  /**
+   * This loads the data for a set of data readers concurrently using up
+   * to nThreads threads.  The data are held until releasePreloadedData is
+   * called, and in the meantime any call to loadData with a data reader
+   * that has the same cache identifier as one of these shares the
+   * preloaded four-vectors rather than reading the data again.  This
+   * allows several AmpToolsInterface instances, each with its own data
+   * readers, to share one copy of the data.  Readers for which
+   * DataReader::isThreadSafe returns true are read concurrently; the
+   * others are read one at a time before the concurrent stage.  Readers
+   * that are NULL or have already been preloaded are skipped.
+   *
+   * \param[in] readers the data readers to load
+   * \param[in] nThreads the maximum number of data readers to load at once,
+   * zero uses the number of hardware threads
+   *
+   * \see releasePreloadedData
+   */
+  static void preloadData( const set< DataReader* >& readers,
+                           unsigned int nThreads );
+  
+  /**
+   * This frees the preloaded data.  Four-vectors that are in use by
+   * objects that called loadData are handed over to those objects.
+   *
+   * \see preloadData
+   */
+  static void releasePreloadedData();
+  
+  /**
+   * This sets a directory, ideally on a fast local disk, that is used to
+   * hold the largest arrays:  the four-vectors, user variables, and (for
+   * CPU calculations) the terms and factors.  Arrays of at least minMB
+   * megabytes are placed in memory-mapped files in this directory rather
+   * than in ordinary memory, so the operating system can page them to
+   * disk and a data set larger than the memory of the machine can be
+   * used.  The loops over events read these arrays sequentially, so the
+   * speed is limited by the bandwidth of the disk once the arrays no
+   * longer fit in memory.  The disk space for an array is reserved when
+   * it is allocated; if the directory lacks room, memory is used instead.
+   * An empty string (the default) disables this.
+   *
+   * \param[in] dir the directory to use, empty to disable
+   * \param[in] minMB the minimum size of an array, in MB, to place on disk
+   */
+  static void setScratchDirectory( const string& dir,
+                                   unsigned long long minMB = 64 );
+  
   /**
    * This routine fills the arrays of data and weights event by event
    * rather than all at once.  If the data arrays pointers are null, then
@@ -274,6 +381,42 @@ struct AmpVecs
   void loadEvent( const Kinematics* pKinematics, unsigned long long iEvent = 0,
                   unsigned long long iNTrueEvents = 1 );
   
+  /**
+   * This routine reads at most maxEvents events from the current position
+   * of the data reader, without resetting the source, and loads them into
+   * this (empty) object.  It allows a large source to be processed in
+   * pieces:  the caller resets the source, then repeatedly loads the next
+   * events, uses them, and deallocates them.
+   *
+   * \param[in] pDataReader a pointer to a user-defined data reader
+   * \param[in] maxEvents the maximum number of events to load
+   *
+   * \returns the number of events that were loaded, which is zero at the
+   * end of the source
+   *
+   * \see loadData
+   */
+  unsigned long long loadNextEvents( DataReader* pDataReader,
+                                     unsigned long long maxEvents );
+  
+  /**
+   * This routine takes ownership of arrays of four-vectors and weights
+   * that have been filled elsewhere, e.g., by a generator, which avoids
+   * creating a Kinematics object for every event.  The arrays must be
+   * allocated with new[] and have the layout of m_pdData and m_pdWeights
+   * for iNTrueEvents events.  If the number of events needs to be padded
+   * for GPU calculations then the arrays are copied and deleted.
+   *
+   * \param[in] pdData the four-vectors with length 4*iNParticles*iNTrueEvents
+   * \param[in] pdWeights the weights with length iNTrueEvents
+   * \param[in] iNTrueEvents the number of events in the arrays
+   * \param[in] iNParticles the number of particles in each event
+   *
+   * \see DataReader::readEvents
+   */
+  void adoptData( GDouble* pdData, GDouble* pdWeights,
+                  unsigned long long iNTrueEvents, unsigned int iNParticles );
+  
   /**
    * A helper routine to get an event i from the array of data and weights.
    * This routine allows the AmpVecs class to behave in the same way that
@@ -314,14 +457,79 @@ struct AmpVecs
    */
   void removeFriend( AmpVecs* dataFriend );
   
+  /**
+   * This function replaces the four-vector array with a block of memory
+   * that holds identical contents but is owned elsewhere, e.g., a
+   * window of memory that is shared by several processes on a node.
+   * The memory is never deleted by this class or the objects it shares
+   * data with, and the owner must keep it valid for as long as the
+   * four-vectors are in use.
+   *
+   * \param[in] pdData pointer to the externally owned four-vectors
+   */
+  void adoptExternalFourVecs( GDouble* pdData );
+  
+  /**
+   * This replaces the user variables of this object with those already
+   * computed by another object that holds the same events and has terms
+   * allocated for an identical intensity manager, e.g., in another
+   * AmpToolsInterface for the same configuration.  The variables are then
+   * only read, so the two objects may be used on different threads, but
+   * the source must remain allocated for as long as this object uses them.
+   * This is not supported with GPU acceleration or with
+   * IntensityManager::setForceUserVarRecalculation.
+   *
+   * \param[in] source the object that computed the user variables
+   */
+  void shareUserVars( const AmpVecs& source );
+  
+  /**
+   * True if the user variables in m_pdUserVars are owned by another object.
+   */
+  bool m_usesSharedUserVars;
+  
   bool m_usesSharedData;
   AmpVecs* m_sharedDataHost;
   
+  /**
+   * True if the four-vectors in m_pdData are owned outside of AmpVecs.
+   */
+  bool m_externalData;
+  
 private:
   
+  void updateWeightInfo( float weight );
+  
+  void loadBulkData( DataReader* pDataReader );
+  void finishArrayLoad();
+  
+  // these use the scratch directory for large arrays if it is set
+  static GDouble* allocateArray( unsigned long long size );
+  static void freeArray( GDouble* array );
+  
+  static string cacheFileName( DataReader* pDataReader );
+  bool loadFromCache( DataReader* pDataReader );
+  void writeToCache( DataReader* pDataReader ) const;
+  
   int m_lastWeightSign;
   set< AmpVecs* > m_sharedDataFriends;
   
+  unsigned long long m_dataHash;
+  
+  static string m_cacheDirectory;
+  
+  // mapped cache files stay open for the life of the program since
+  // any number of AmpVecs objects may use the four-vectors
+  static map< string, MappedFile* > m_mappedFiles;
+  
+  static map< string, AmpVecs* > m_preloadedData;
+  
+  static string m_scratchDirectory;
+  static unsigned long long m_scratchMinBytes;
+  
+  // arrays that are mapped to files in the scratch directory
+  static map< const GDouble*, MappedFile* > m_scratchArrays;
+  
   static const char* kModule;
 };
 
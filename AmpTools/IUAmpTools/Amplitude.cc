@@ -43,6 +43,7 @@
 #include "IUAmpTools/Amplitude.h"
 #include "IUAmpTools/AmpParameter.h"
 #include "IUAmpTools/Kinematics.h"
+#include "IUAmpTools/EventLoopThreads.h"
 
 #include "IUAmpTools/report.h"
 const char* Amplitude::kModule = "Amplitude";
@@ -97,38 +98,41 @@ SCOREP_USER_REGION_BEGIN( calcUserVarsAll, "calcUserVarsAll", SCOREP_USER_REGION
   int iNParticles = pvPermutations->at(0).size();
   assert( iNParticles );
   
-  GDouble** pKin = new GDouble*[iNParticles];
-  
-  int i, j, iEvent;
   for( iPermutation = 0; iPermutation < iNPermutations; iPermutation++ ){
 
     m_currentPermutation = (*pvPermutations)[iPermutation];
 
-    for( iEvent=0; iEvent<iNEvents; iEvent++ ){
-
-      // pKin is an array of pointers to the particle four-momentum
-      // that gets reordered for each permutation so the user
-      // doesn't need to deal with permutations in their calcAmplitude
-      // routine
-
-      unsigned int eventOffset = 4*iNParticles*iEvent;
-      
-      for( i = 0; i < iNParticles; i++ ){
-
-        j = m_currentPermutation[i];
-        pKin[i] = &(pdData[eventOffset+4*j]);
-      }
-
-      unsigned int userIndex = iNEvents*iPermutation*numVars + iEvent*numVars;
-      calcUserVars( pKin, &(pdUserVars[userIndex]) );
-    }
+    // the permutation is fixed while the events are (possibly) split
+    // among several threads -- see EventLoopThreads
+    EventLoopThreads::run( iNEvents,
+      [&]( unsigned int, unsigned long first, unsigned long last ){
+        
+        // pKin is an array of pointers to the particle four-momentum
+        // that gets reordered for each permutation so the user
+        // doesn't need to deal with permutations in their calcAmplitude
+        // routine
+
+        vector< GDouble* > pKin( iNParticles );
+
+        for( unsigned long iEvent = first; iEvent < last; iEvent++ ){
+          
+          unsigned int eventOffset = 4*iNParticles*iEvent;
+          
+          for( int i = 0; i < iNParticles; i++ ){
+            
+            int j = m_currentPermutation[i];
+            pKin[i] = &(pdData[eventOffset+4*j]);
+          }
+          
+          unsigned int userIndex = iNEvents*iPermutation*numVars + iEvent*numVars;
+          calcUserVars( &(pKin[0]), &(pdUserVars[userIndex]) );
+        }
+      } );
   }
   
 #ifdef SCOREP
 SCOREP_USER_REGION_END( calcUserVarsAll )
 #endif
-  
-  delete[] pKin;
 }
 
 void
@@ -142,8 +146,6 @@ SCOREP_USER_REGION_DEFINE( calcAmplitudeAll )
 SCOREP_USER_REGION_BEGIN( calcAmplitudeAll, "calcAmplitudeAll", SCOREP_USER_REGION_TYPE_COMMON )
 #endif
   
-  complex< GDouble > cRes;
-  
   unsigned int numVars = numUserVars();
 
   int iPermutation, iNPermutations = pvPermutations->size();
@@ -152,48 +154,51 @@ SCOREP_USER_REGION_BEGIN( calcAmplitudeAll, "calcAmplitudeAll", SCOREP_USER_REGI
   int iNParticles = pvPermutations->at(0).size();
   assert( iNParticles );
   
-  GDouble** pKin = new GDouble*[iNParticles];
-  
-   int i, j, iEvent;
   for( iPermutation = 0; iPermutation < iNPermutations; iPermutation++ ){
 
     m_currentPermutation = (*pvPermutations)[iPermutation];
 
-    for( iEvent=0; iEvent<iNEvents; iEvent++ ){
-
-      // pKin is an array of pointers to the particle four-momentum
-      // that gets reordered for each permutation so the user
-      // doesn't need to deal with permutations in their calcAmplitude
-      // routine
-
-      unsigned int eventOffset = 4*iNParticles*iEvent;
-
-      for( i = 0; i < iNParticles; i++ ){
-
-        j = m_currentPermutation[i];
-        pKin[i] = &(pdData[eventOffset+4*j]);
-      }
-
-      unsigned int userIndex = iNEvents*iPermutation*numVars + iEvent*numVars;
-
-      if( numVars != 0 ){
-      
-        cRes = calcAmplitude( pKin, &(pdUserVars[userIndex]) );
-      }
-      else{
-        cRes = calcAmplitude( pKin );
-      }
-      
-      pdAmps[2*iNEvents*iPermutation+2*iEvent] = cRes.real();
-      pdAmps[2*iNEvents*iPermutation+2*iEvent+1] = cRes.imag();
-    }
+    EventLoopThreads::run( iNEvents,
+      [&]( unsigned int, unsigned long first, unsigned long last ){
+
+        complex< GDouble > cRes;
+        
+        // pKin is an array of pointers to the particle four-momentum
+        // that gets reordered for each permutation so the user
+        // doesn't need to deal with permutations in their calcAmplitude
+        // routine
+
+        vector< GDouble* > pKin( iNParticles );
+        
+        for( unsigned long iEvent = first; iEvent < last; iEvent++ ){
+          
+          unsigned int eventOffset = 4*iNParticles*iEvent;
+          
+          for( int i = 0; i < iNParticles; i++ ){
+            
+            int j = m_currentPermutation[i];
+            pKin[i] = &(pdData[eventOffset+4*j]);
+          }
+          
+          unsigned int userIndex = iNEvents*iPermutation*numVars + iEvent*numVars;
+          
+          if( numVars != 0 ){
+            
+            cRes = calcAmplitude( &(pKin[0]), &(pdUserVars[userIndex]) );
+          }
+          else{
+            cRes = calcAmplitude( &(pKin[0]) );
+          }
+          
+          pdAmps[2*iNEvents*iPermutation+2*iEvent] = cRes.real();
+          pdAmps[2*iNEvents*iPermutation+2*iEvent+1] = cRes.imag();
+        }
+      } );
   }
 
 #ifdef SCOREP
 SCOREP_USER_REGION_END( calcAmplitudeAll )
 #endif
-  
-  delete[] pKin;
 }
 
 
@@ -350,6 +355,21 @@ Amplitude::containsFreeParameters() const {
   return hasFreeParam;
 }
 
+vector< double >
+Amplitude::parameterValues() const {
+  
+  vector< double > values;
+  
+  for( vector< AmpParameter* >::const_iterator parItr = m_registeredParams.begin();
+      parItr != m_registeredParams.end();
+      ++parItr ){
+    
+    values.push_back( **parItr );
+  }
+  
+  return values;
+}
+
 bool
 Amplitude::setParPtr( const string& name, const double* ptr ) const {
   
@@ -134,6 +134,12 @@ public:
    */
   bool containsFreeParameters() const;
   
+  /**
+   * Returns the current values of all registered parameters in the
+   * order that they were registered.
+   */
+  vector< double > parameterValues() const;
+  
   /**
    * If the user intendends to store intermediate calculations that are
    * static but associated with each event and each permutation of this
@@ -39,15 +39,39 @@
 #include <fstream>
 #include <string.h>
 #include <set>
+#include <iomanip>
+#include <cstdio>
+
+#include <unistd.h>
 
 using namespace std;
 
 #include "IUAmpTools/AmplitudeManager.h"
 #include "IUAmpTools/NormIntInterface.h"
+#include "IUAmpTools/EventLoopThreads.h"
+#include "IUAmpTools/MappedFile.h"
 #include "IUAmpTools/report.h"
 
 const char* AmplitudeManager::kModule = "AmplitudeManager";
 
+string AmplitudeManager::m_cacheDirectory = "";
+
+// Files in the cache directory start with this header, which is
+// followed by the key (padded to a multiple of eight bytes) and
+// the values.  Values are stored in native byte order.
+
+struct AmplitudeCacheHeader {
+  
+  char magic[8];
+  unsigned int version;
+  unsigned int bytesPerValue;
+  unsigned long long nValues;
+  unsigned long long keyLength;
+};
+
+static const char kAmpCacheMagic[8] = { 'A', 'M', 'P', 'C', 'A', 'C', 'H', 'E' };
+static const unsigned int kAmpCacheVersion = 1;
+
 #ifdef SCOREP
 #include <scorep/SCOREP_User.h>
 #endif
@@ -259,6 +283,29 @@ AmplitudeManager::hasTermWithFreeParam() const {
   return false;
 }
 
+int
+AmplitudeManager::termIteration( int iTerm ) const {
+  
+  const vector< const Amplitude* >& vAmps =
+  m_mapNameToAmps.find( getTermNames().at( iTerm ) )->second;
+  
+  // iteration numbers only increase, so the sum over the factors
+  // changes whenever one of the factors is updated
+  int iteration = 0;
+  
+  for( vector< const Amplitude* >::const_iterator ampItr = vAmps.begin();
+      ampItr != vAmps.end();
+      ++ampItr ){
+    
+    map< const Amplitude*, int >::const_iterator iterItr =
+    m_ampIteration.find( *ampItr );
+    
+    if( iterItr != m_ampIteration.end() ) iteration += iterItr->second;
+  }
+  
+  return iteration;
+}
+
 void
 AmplitudeManager::calcUserVars( AmpVecs& a ) const
 {
@@ -283,7 +330,7 @@ SCOREP_USER_REGION_BEGIN( calcUserVars, "calcUserVars", SCOREP_USER_REGION_TYPE_
     const vector< vector< int > >& vvPermuations = permItr->second;
     int iNPerms = vvPermuations.size();
     
-    vector< const Amplitude* > vAmps =
+    const vector< const Amplitude* >& vAmps =
     m_mapNameToAmps.find(ampNames.at(iAmpIndex))->second;
     
     int iFactor, iNFactors = vAmps.size();
@@ -364,12 +411,33 @@ SCOREP_USER_REGION_BEGIN( calcUserVars, "calcUserVars", SCOREP_USER_REGION_TYPE_
       
       // calculation of user-defined kinematics data
       // is something that should only be done once
-      // per fit, so do it on the CPU no matter what
+      // per fit, so do it on the CPU no matter what --
+      // if a cache is in use, first look for the result
+      // of a previous calculation on the same data
       
-      pCurrAmp->
-        calcUserVarsAll( a.m_pdData,
-                         a.m_pdUserVars + thisOffset,
-                         a.m_iNEvents, &vvPermuations );
+      string cacheKey;
+      if( !m_cacheDirectory.empty() && a.dataHash() != 0 ){
+        
+        ostringstream key;
+        key << "userVars " << ( pCurrAmp->areUserVarsStatic() ?
+                                pCurrAmp->name() : pCurrAmp->identifier() )
+            << " perms " << permutationString( vvPermuations )
+            << " nVars " << iNVars << " nEvents " << a.m_iNEvents
+            << " data " << hex << a.dataHash();
+        cacheKey = key.str();
+      }
+      
+      if( cacheKey.empty() ||
+          !readCache( cacheKey, a.m_pdUserVars + thisOffset, iNData ) ){
+        
+        pCurrAmp->
+          calcUserVarsAll( a.m_pdData,
+                           a.m_pdUserVars + thisOffset,
+                           a.m_iNEvents, &vvPermuations );
+        
+        if( !cacheKey.empty() )
+          writeCache( cacheKey, a.m_pdUserVars + thisOffset, iNData );
+      }
          
 #ifdef GPU_ACCELERATION
       
@@ -460,7 +528,7 @@ SCOREP_USER_REGION_BEGIN( calcTerms, "calcTerms", SCOREP_USER_REGION_TYPE_COMMON
     const vector< vector< int > >& vvPermuations = permItr->second;
     int iNPermutations = vvPermuations.size();
     
-    vector< const Amplitude* > vAmps =
+    const vector< const Amplitude* >& vAmps =
     m_mapNameToAmps.find(ampNames.at(iAmpIndex))->second;
     
     int iFactor, iNFactors = vAmps.size();
@@ -506,6 +574,33 @@ SCOREP_USER_REGION_BEGIN( calcTerms, "calcTerms", SCOREP_USER_REGION_TYPE_COMMON
     
     modifiedTerm[iAmpIndex] = true;
     
+#ifndef GPU_ACCELERATION
+    
+    // terms without free parameters are computed once per data set and
+    // can be read from the cache if they were computed by an earlier job
+    
+    string cacheKey;
+    if( !m_cacheDirectory.empty() && m_vbIsAmpFixed[iAmpIndex] &&
+        a.dataHash() != 0 ){
+      
+      ostringstream key;
+      key << "term";
+      for( iFactor = 0; iFactor < iNFactors; ++iFactor ){
+        
+        key << " " << vAmps[iFactor]->identifier() << " pars";
+        vector< double > pars = vAmps[iFactor]->parameterValues();
+        for( unsigned int iPar = 0; iPar < pars.size(); ++iPar )
+          key << " " << setprecision( 17 ) << pars[iPar];
+      }
+      key << " perms " << permutationString( vvPermuations )
+          << " nEvents " << a.m_iNEvents << " data " << hex << a.dataHash();
+      cacheKey = key.str();
+      
+      if( readCache( cacheKey, a.m_pdAmps + 2 * a.m_iNEvents * iAmpIndex,
+                     2 * a.m_iNEvents ) ) continue;
+    }
+#endif
+    
     // calculate all the factors that make up an amplitude for
     // for all events serially on CPU or in parallel on GPU
     unsigned long long iLocalOffset = 0;
@@ -541,9 +636,6 @@ SCOREP_USER_REGION_BEGIN( calcTerms, "calcTerms", SCOREP_USER_REGION_TYPE_COMMON
 #ifndef GPU_ACCELERATION
     
     GDouble dSymmFactor = 1.0f/sqrt( iNPermutations );
-    GDouble dAmpFacRe, dAmpFacIm, dTRe, dTIm;
-    int iEvent, iPerm;
-    unsigned long long iOffsetA, iOffsetP, iOffsetF;
     
     // re-ordering of data will be useful to not fall out of (CPU) memory cache!!!
     
@@ -552,37 +644,48 @@ SCOREP_USER_REGION_BEGIN( calcTerms, "calcTerms", SCOREP_USER_REGION_TYPE_COMMON
            2 * a.m_iNEvents * sizeof(GDouble) );
     
     // only sum over the true events from data and skip paddings
-    for( iEvent=0; iEvent < a.m_iNTrueEvents; iEvent++ )
-    {
-      iOffsetA = 2 * a.m_iNEvents * iAmpIndex + 2 * iEvent;
-      
-      for( iPerm = 0; iPerm < iNPermutations; iPerm++ )
-      {
-        iOffsetP = 2 * a.m_iNEvents * iPerm + 2 * iEvent;
+    EventLoopThreads::run( a.m_iNTrueEvents,
+      [&]( unsigned int, unsigned long first, unsigned long last ){
         
-        dAmpFacRe = a.m_pdAmpFactors[iOffsetP];
-        dAmpFacIm = a.m_pdAmpFactors[iOffsetP+1];
+        GDouble dAmpFacRe, dAmpFacIm, dTRe, dTIm;
+        unsigned long long iOffsetA, iOffsetP, iOffsetF;
         
-        for( iFactor = 1; iFactor < iNFactors; iFactor++ )
+        for( unsigned long iEvent = first; iEvent < last; iEvent++ )
         {
-          iOffsetF = iOffsetP + 2 * a.m_iNEvents * iNPermutations * iFactor;
+          iOffsetA = 2 * a.m_iNEvents * iAmpIndex + 2 * iEvent;
           
-          dTRe = dAmpFacRe;
-          dTIm = dAmpFacIm;
-
-          dAmpFacRe = dTRe * a.m_pdAmpFactors[iOffsetF] -
-          dTIm * a.m_pdAmpFactors[iOffsetF+1];
-          dAmpFacIm = dTRe * a.m_pdAmpFactors[iOffsetF+1] +
-          dTIm * a.m_pdAmpFactors[iOffsetF];
+          for( int iPerm = 0; iPerm < iNPermutations; iPerm++ )
+          {
+            iOffsetP = 2 * a.m_iNEvents * iPerm + 2 * iEvent;
+            
+            dAmpFacRe = a.m_pdAmpFactors[iOffsetP];
+            dAmpFacIm = a.m_pdAmpFactors[iOffsetP+1];
+            
+            for( int iFac = 1; iFac < iNFactors; iFac++ )
+            {
+              iOffsetF = iOffsetP + 2 * a.m_iNEvents * iNPermutations * iFac;
+              
+              dTRe = dAmpFacRe;
+              dTIm = dAmpFacIm;
+              
+              dAmpFacRe = dTRe * a.m_pdAmpFactors[iOffsetF] -
+              dTIm * a.m_pdAmpFactors[iOffsetF+1];
+              dAmpFacIm = dTRe * a.m_pdAmpFactors[iOffsetF+1] +
+              dTIm * a.m_pdAmpFactors[iOffsetF];
+            }
+            
+            a.m_pdAmps[iOffsetA]   += dAmpFacRe;
+            a.m_pdAmps[iOffsetA+1] += dAmpFacIm;
+          }
+          
+          a.m_pdAmps[iOffsetA]   *= dSymmFactor;
+          a.m_pdAmps[iOffsetA+1] *= dSymmFactor;
         }
-        
-        a.m_pdAmps[iOffsetA]   += dAmpFacRe;
-        a.m_pdAmps[iOffsetA+1] += dAmpFacIm;
-      }
-
-      a.m_pdAmps[iOffsetA]   *= dSymmFactor;
-      a.m_pdAmps[iOffsetA+1] *= dSymmFactor;
-    }
+      } );
+    
+    if( !cacheKey.empty() )
+      writeCache( cacheKey, a.m_pdAmps + 2 * a.m_iNEvents * iAmpIndex,
+                  2 * a.m_iNEvents );
     
 #else
     // on the GPU the terms are assembled and never copied out
@@ -603,7 +706,7 @@ SCOREP_USER_REGION_BEGIN( calcTerms, "calcTerms", SCOREP_USER_REGION_TYPE_COMMON
   // parameter
   for( iAmpIndex = 0; iAmpIndex < iNAmps; iAmpIndex++ )
   {
-    vector< const Amplitude* > vAmps =
+    const vector< const Amplitude* >& vAmps =
     m_mapNameToAmps.find(ampNames.at(iAmpIndex))->second;
     
     int iFactor, iNFactors = vAmps.size();
@@ -623,7 +726,7 @@ SCOREP_USER_REGION_END( calcTerms )
 }
 
 double
-AmplitudeManager::calcIntensities( AmpVecs& a ) const
+AmplitudeManager::calcIntensities( AmpVecs& a, bool updateTerms ) const
 {
 #ifdef SCOREP
 SCOREP_USER_REGION_DEFINE( calcIntensities )                                                                                    
@@ -636,8 +739,11 @@ SCOREP_USER_REGION_BEGIN( calcIntensities, "calcIntensities", SCOREP_USER_REGION
   
   double maxInten = 0;
   
-  // first update the amplitudes
-  calcTerms( a );
+  // first update the amplitudes -- the caller may skip this if the
+  // amplitudes from a previous call are still valid and only the
+  // production factors have changed
+  if( !a.m_termsValid ) updateTerms = true;
+  if( updateTerms ) calcTerms( a );
 
 #ifdef GPU_ACCELERATION
   // In GPU running mode amplitudes are maintained on the GPU and
@@ -649,17 +755,27 @@ SCOREP_USER_REGION_BEGIN( calcIntensities, "calcIntensities", SCOREP_USER_REGION
   // GPU accelerated intensity calculation, just a GPU accelerated
   // log( intensity ) calculation.
   
-  if( a.m_pdAmps == NULL ) a.allocateCPUAmpStorage( *this );
-  a.m_gpuMan.copyAmpsFromGPU( a );
+  if( a.m_pdAmps == NULL ){
+    
+    a.allocateCPUAmpStorage( *this );
+    updateTerms = true;
+  }
+  if( updateTerms ) a.m_gpuMan.copyAmpsFromGPU( a );
 #endif
 
   const vector< string >& ampNames = getTermNames();
   
   int iNAmps = ampNames.size();
     
-  int i,j,iEvent;
+  int i,j;
   complex< double > cTmp;
-  double cViVjRe, cViVjIm, cAiAjRe, cAiAjIm;
+  
+  // first compute the products of production factors for all
+  // coherent pairs of amplitudes, then loop over events -- the
+  // event loop may be split over multiple threads
+  
+  vector< int > iIndex, jIndex;
+  vector< double > cViVjRe, cViVjIm;
   
   for( i = 0; i < iNAmps; i++ ){
     for( j = 0; j <= i; j++ ){
@@ -679,36 +795,60 @@ SCOREP_USER_REGION_BEGIN( calcIntensities, "calcIntensities", SCOREP_USER_REGION
       cTmp /= a.m_iNTrueEvents;
 #endif
       
-      cViVjRe = cTmp.real();
-      cViVjIm = cTmp.imag();
+      if( i != j ) cTmp *= 2;
       
-      if( i != j ) {
-        
-        cViVjRe *= 2;
-        cViVjIm *= 2;
-      }
+      iIndex.push_back( i );
+      jIndex.push_back( j );
+      cViVjRe.push_back( cTmp.real() );
+      cViVjIm.push_back( cTmp.imag() );
+    }
+  }
+  
+  int nPairs = iIndex.size();
+  
+  vector< double > blockMax( EventLoopThreads::numBlocks( a.m_iNTrueEvents ), 0 );
+  
+  EventLoopThreads::run( a.m_iNTrueEvents,
+    [&]( unsigned int iBlock, unsigned long first, unsigned long last ){
+      
+      double cAiAjRe, cAiAjIm;
       
-      for( iEvent=0; iEvent < a.m_iNTrueEvents; iEvent++ ) {
+      for( int iPair = 0; iPair < nPairs; iPair++ ){
         
-        cAiAjRe = a.m_pdAmps[2*a.m_iNEvents*i+2*iEvent] *
-        a.m_pdAmps[2*a.m_iNEvents*j+2*iEvent] +
-        a.m_pdAmps[2*a.m_iNEvents*i+2*iEvent+1] *
-        a.m_pdAmps[2*a.m_iNEvents*j+2*iEvent+1];
+        int i = iIndex[iPair];
+        int j = jIndex[iPair];
         
-        cAiAjIm = -a.m_pdAmps[2*a.m_iNEvents*i+2*iEvent] *
-        a.m_pdAmps[2*a.m_iNEvents*j+2*iEvent+1] +
-        a.m_pdAmps[2*a.m_iNEvents*i+2*iEvent+1] *
-        a.m_pdAmps[2*a.m_iNEvents*j+2*iEvent];
+        for( unsigned long iEvent = first; iEvent < last; iEvent++ ) {
+          
+          cAiAjRe = a.m_pdAmps[2*a.m_iNEvents*i+2*iEvent] *
+          a.m_pdAmps[2*a.m_iNEvents*j+2*iEvent] +
+          a.m_pdAmps[2*a.m_iNEvents*i+2*iEvent+1] *
+          a.m_pdAmps[2*a.m_iNEvents*j+2*iEvent+1];
+          
+          cAiAjIm = -a.m_pdAmps[2*a.m_iNEvents*i+2*iEvent] *
+          a.m_pdAmps[2*a.m_iNEvents*j+2*iEvent+1] +
+          a.m_pdAmps[2*a.m_iNEvents*i+2*iEvent+1] *
+          a.m_pdAmps[2*a.m_iNEvents*j+2*iEvent];
+          
+          a.m_pdIntensity[iEvent] +=
+          ( cViVjRe[iPair] * cAiAjRe - cViVjIm[iPair] * cAiAjIm );
+        }
+      }
+      
+      for( unsigned long iEvent = first; iEvent < last; iEvent++ ) {
         
-        a.m_pdIntensity[iEvent] += ( cViVjRe * cAiAjRe - cViVjIm * cAiAjIm );
+        a.m_pdIntensity[iEvent] *= a.m_pdWeights[iEvent];
+        if( a.m_pdIntensity[iEvent] > blockMax[iBlock] ){
+          
+          blockMax[iBlock] = a.m_pdIntensity[iEvent];
+        }
       }
-    }
-  }
-    
-  for( iEvent=0; iEvent < a.m_iNTrueEvents; iEvent++ ) {
+    } );
+  
+  for( vector< double >::const_iterator blk = blockMax.begin();
+       blk != blockMax.end(); ++blk ){
     
-    a.m_pdIntensity[iEvent] *= a.m_pdWeights[iEvent];
-    if( a.m_pdIntensity[iEvent] > maxInten ) maxInten = a.m_pdIntensity[iEvent];
+    if( *blk > maxInten ) maxInten = *blk;
   }
   
 #ifdef SCOREP
@@ -739,15 +879,41 @@ SCOREP_USER_REGION_BEGIN( calcSumLogIntensity, "calcSumLogIntensity", SCOREP_USE
   
   calcIntensities( a );
   
-  for( int iEvent=0; iEvent < a.m_iNTrueEvents; iEvent++ ){
+  // each block of events accumulates its own partial sum and these
+  // are added in a fixed order so the result does not depend on
+  // the order in which the threads finish
+  vector< double > blockSum( EventLoopThreads::numBlocks( a.m_iNTrueEvents ), 0 );
+  
+  // events that are resampled enter the sum with their multiplicity
+  const GDouble* mult = a.m_pdMultiplicity;
+  
+  EventLoopThreads::run( a.m_iNTrueEvents,
+    [&]( unsigned int iBlock, unsigned long first, unsigned long last ){
+      
+      double sum = 0;
+      
+      for( unsigned long iEvent = first; iEvent < last; iEvent++ ){
+        
+        if( mult != NULL && mult[iEvent] == 0 ) continue;
+        
+        // here divide out the weight that was put into the intensity calculation
+        // and weight the log -- in practice this just contributes an extra constant
+        // term in the likelihood equal to sum -w_i * log( w_i ), but the division
+        // helps avoid problems with negative weights, which may be used
+        // in background subtraction
+        double term = a.m_pdWeights[iEvent] *
+        G_LOG( a.m_pdIntensity[iEvent] / a.m_pdWeights[iEvent] );
+        
+        sum += ( mult != NULL ? mult[iEvent] * term : term );
+      }
+      
+      blockSum[iBlock] = sum;
+    } );
+  
+  for( vector< double >::const_iterator blk = blockSum.begin();
+       blk != blockSum.end(); ++blk ){
     
-    // here divide out the weight that was put into the intensity calculation
-    // and weight the log -- in practice this just contributes an extra constant
-    // term in the likelihood equal to sum -w_i * log( w_i ), but the division
-    // helps avoid problems with negative weights, which may be used
-    // in background subtraction
-    dSumLogI += a.m_pdWeights[iEvent] *
-    G_LOG( a.m_pdIntensity[iEvent] / a.m_pdWeights[iEvent] );
+    dSumLogI += *blk;
   }
   
 #else
@@ -889,27 +1055,47 @@ SCOREP_USER_REGION_BEGIN( calcIntegralsA, "calcIntegralsA", SCOREP_USER_REGION_T
   }
   
 #ifndef GPU_ACCELERATION
-  for( int iTerm = 0; iTerm < nCompute; ++iTerm ){
-    
-    int i = iIndex[iTerm];
-    int j = jIndex[iTerm];
-    
-    for( int iEvent = 0; iEvent < a.m_iNTrueEvents; iEvent++ ) {
-
-      //AiAj*
-      result[2*iTerm] += a.m_pdWeights[iEvent] *
-      ( a.m_pdAmps[2*a.m_iNEvents*i+2*iEvent] *
-       a.m_pdAmps[2*a.m_iNEvents*j+2*iEvent] +
-       a.m_pdAmps[2*a.m_iNEvents*i+2*iEvent+1] *
-       a.m_pdAmps[2*a.m_iNEvents*j+2*iEvent+1] );
-
-      if( i == j ) continue;  // diagonal elements are real
+  
+  // each block of events fills its own copy of the result vector
+  // and the copies are summed in block order afterwards
+  unsigned int nBlocks = EventLoopThreads::numBlocks( a.m_iNTrueEvents );
+  vector< vector< double > > blockResult( nBlocks,
+                                          vector< double >( 2*nCompute, 0 ) );
+  
+  EventLoopThreads::run( a.m_iNTrueEvents,
+    [&]( unsigned int iBlock, unsigned long first, unsigned long last ){
+      
+      vector< double >& res = blockResult[iBlock];
+      
+      for( int iTerm = 0; iTerm < nCompute; ++iTerm ){
+        
+        int i = iIndex[iTerm];
+        int j = jIndex[iTerm];
+        
+        for( unsigned long iEvent = first; iEvent < last; iEvent++ ) {
+          
+          //AiAj*
+          res[2*iTerm] += a.m_pdWeights[iEvent] *
+          ( a.m_pdAmps[2*a.m_iNEvents*i+2*iEvent] *
+           a.m_pdAmps[2*a.m_iNEvents*j+2*iEvent] +
+           a.m_pdAmps[2*a.m_iNEvents*i+2*iEvent+1] *
+           a.m_pdAmps[2*a.m_iNEvents*j+2*iEvent+1] );
+          
+          if( i == j ) continue;  // diagonal elements are real
+          
+          res[2*iTerm+1] += a.m_pdWeights[iEvent] *
+          ( -a.m_pdAmps[2*a.m_iNEvents*i+2*iEvent] *
+           a.m_pdAmps[2*a.m_iNEvents*j+2*iEvent+1] +
+           a.m_pdAmps[2*a.m_iNEvents*i+2*iEvent+1] *
+           a.m_pdAmps[2*a.m_iNEvents*j+2*iEvent] );
+        }
+      }
+    } );
+  
+  for( unsigned int iBlock = 0; iBlock < nBlocks; ++iBlock ){
+    for( int k = 0; k < 2*nCompute; ++k ){
       
-      result[2*iTerm+1] += a.m_pdWeights[iEvent] *
-      ( -a.m_pdAmps[2*a.m_iNEvents*i+2*iEvent] *
-       a.m_pdAmps[2*a.m_iNEvents*j+2*iEvent+1] +
-       a.m_pdAmps[2*a.m_iNEvents*i+2*iEvent+1] *
-       a.m_pdAmps[2*a.m_iNEvents*j+2*iEvent] );
+      result[k] += blockResult[iBlock][k];
     }
   }
 
@@ -1280,3 +1466,126 @@ AmplitudeManager::generateSymmetricCombos( const vector< pair< int, int > >& pre
   }
 }
 
+string
+AmplitudeManager::permutationString( const vector< vector< int > >& perms ) const {
+  
+  ostringstream permStr;
+  
+  for( vector< vector< int > >::const_iterator perm = perms.begin();
+       perm != perms.end(); ++perm ){
+    
+    permStr << "(";
+    for( vector< int >::const_iterator index = perm->begin();
+         index != perm->end(); ++index ){
+      
+      permStr << " " << *index;
+    }
+    permStr << " )";
+  }
+  
+  return permStr.str();
+}
+
+static string
+cacheFileName( const string& dir, const string& key ){
+  
+  // the key can contain any characters so use a hash of it for
+  // the file name -- the full key is stored in the file and
+  // checked when it is read
+  unsigned long long hash = 14695981039346656037ULL;
+  for( string::const_iterator c = key.begin(); c != key.end(); ++c ){
+    
+    hash ^= static_cast< unsigned char >( *c );
+    hash *= 1099511628211ULL;
+  }
+  
+  ostringstream fileName;
+  fileName << dir << "/" << hex << setw( 16 ) << setfill( '0' ) << hash << ".amc";
+  
+  return fileName.str();
+}
+
+bool
+AmplitudeManager::readCache( const string& key, GDouble* dest,
+                             unsigned long long n ) const {
+  
+  string fileName = cacheFileName( m_cacheDirectory, key );
+  
+  MappedFile file( fileName );
+  if( !file.isValid() ) return false;
+  
+  const AmplitudeCacheHeader* header =
+    reinterpret_cast< const AmplitudeCacheHeader* >( file.data() );
+  
+  unsigned long long keyBytes = 8 * ( ( key.size() + 7 ) / 8 );
+  
+  bool valid = ( file.size() >= sizeof( AmplitudeCacheHeader ) );
+  
+  valid = valid &&
+    ( memcmp( header->magic, kAmpCacheMagic, sizeof( kAmpCacheMagic ) ) == 0 ) &&
+    ( header->version == kAmpCacheVersion ) &&
+    ( header->bytesPerValue == sizeof( GDouble ) ) &&
+    ( header->nValues == n ) &&
+    ( header->keyLength == key.size() ) &&
+    ( file.size() == sizeof( AmplitudeCacheHeader ) + keyBytes + n * sizeof( GDouble ) );
+  
+  valid = valid &&
+    ( key.compare( 0, string::npos, file.data() + sizeof( AmplitudeCacheHeader ),
+                   key.size() ) == 0 );
+  
+  if( !valid ) return false;
+  
+  report( DEBUG, kModule ) << "Reading " << n << " values from cache file "
+  << fileName << endl;
+  
+  memcpy( dest, file.data() + sizeof( AmplitudeCacheHeader ) + keyBytes,
+          n * sizeof( GDouble ) );
+  
+  return true;
+}
+
+void
+AmplitudeManager::writeCache( const string& key, const GDouble* src,
+                              unsigned long long n ) const {
+  
+  string fileName = cacheFileName( m_cacheDirectory, key );
+  
+  // write to a temporary file and rename it so that other jobs never
+  // see a partially written file
+  ostringstream tmpName;
+  tmpName << fileName << ".tmp" << getpid();
+  
+  ofstream outFile( tmpName.str().c_str(), ios::binary );
+  
+  if( !outFile ){
+    
+    report( WARNING, kModule ) << "Unable to write cache file " << tmpName.str() << endl;
+    return;
+  }
+  
+  AmplitudeCacheHeader header;
+  memcpy( header.magic, kAmpCacheMagic, sizeof( kAmpCacheMagic ) );
+  header.version = kAmpCacheVersion;
+  header.bytesPerValue = sizeof( GDouble );
+  header.nValues = n;
+  header.keyLength = key.size();
+  
+  outFile.write( reinterpret_cast< const char* >( &header ), sizeof( header ) );
+  
+  string paddedKey = key;
+  paddedKey.resize( 8 * ( ( key.size() + 7 ) / 8 ), '\0' );
+  outFile.write( paddedKey.c_str(), paddedKey.size() );
+  
+  outFile.write( reinterpret_cast< const char* >( src ), n * sizeof( GDouble ) );
+  outFile.close();
+  
+  if( !outFile || rename( tmpName.str().c_str(), fileName.c_str() ) != 0 ){
+    
+    report( WARNING, kModule ) << "Unable to write cache file " << fileName << endl;
+    remove( tmpName.str().c_str() );
+    return;
+  }
+  
+  report( DEBUG, kModule ) << "Wrote " << n << " values to cache file "
+  << fileName << endl;
+}
@@ -181,11 +181,16 @@ public:
    * \param[in,out] ampVecs a reference to the AmpVecs storage structure,
    * four vectors will be read from this class and intensities written to it.
    *
+   * \param[in] updateTerms if false the amplitudes already stored in ampVecs
+   * are used without calling calcTerms
+   *
    * \see calcAmplitudes
    * \see calcSumLogIntensity
    * \see calcIntegrals
    */
-  double calcIntensities( AmpVecs& ampVecs ) const;
+  double calcIntensities( AmpVecs& ampVecs, bool updateTerms ) const;
+  double calcIntensities( AmpVecs& ampVecs ) const {
+    return calcIntensities( ampVecs, true ); }
 
   /**
    * This function calculates and returns the sum of the log of the intensities
@@ -267,6 +272,14 @@ public:
    */
   bool hasTermWithFreeParam() const;
   
+  /**
+   * This function returns a number that changes whenever a parameter
+   * of any factor of the amplitude with index iTerm is updated.
+   *
+   * \see updatePar
+   */
+  int termIteration( int iTerm ) const;
+  
   /**
    * This function will return true if every amplitude factor can be
    * calculated from user-defined data variables.  In some instances
@@ -426,11 +439,30 @@ public:
    */
   void updatePar( const string& parName ) const;
   
+  /**
+   * This sets a directory that is used to store user variables and the
+   * values of terms that have no free parameters.  The blocks are
+   * identified by the amplitude identifier (or name, for static user
+   * variables), the permutations, the parameter values, and a hash of
+   * the four-vectors of the data set.  If a matching block exists it is
+   * read instead of being computed.  An empty string (the default)
+   * disables the cache.
+   *
+   * \param[in] dir the directory to use, empty to disable the cache
+   */
+  static void setCacheDirectory( const string& dir ) { m_cacheDirectory = dir; }
+  static const string& cacheDirectory() { return m_cacheDirectory; }
+  
   
 
 
 private:
   
+  // helpers for the optional cache of user variables and terms
+  string permutationString( const vector< vector< int > >& perms ) const;
+  bool readCache( const string& key, GDouble* dest, unsigned long long n ) const;
+  void writeCache( const string& key, const GDouble* src, unsigned long long n ) const;
+  
   // recursive routine to symmetrize final state
   void generateSymmetricCombos( const vector< pair< int, int > >& prevSwaps,
                                vector< vector< pair< int, int > > > remainingSwaps,
@@ -467,6 +499,8 @@ private:
   mutable map< AmpVecs*, map< const Amplitude*, int > > m_dataAmpIteration;
   mutable map< string, unsigned long long > m_staticUserVarsOffset;
   
+  static string m_cacheDirectory;
+  
   static const char* kModule;
 };
 
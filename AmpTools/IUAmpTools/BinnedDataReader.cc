@@ -0,0 +1,195 @@
+//******************************************************************************
+// This file is part of AmpTools, a package for performing Amplitude Analysis
+// 
+// Copyright Trustees of Indiana University 2010, all rights reserved
+// 
+// This software written by Matthew Shepherd, Ryan Mitchell, and 
+//                  Hrayr Matevosyan at Indiana University, Bloomington
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice and author attribution, this list of conditions and the
+//    following disclaimer. 
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice and author attribution, this list of conditions and the
+//    following disclaimer in the documentation and/or other materials
+//    provided with the distribution.
+// 3. Neither the name of the University nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// 
+// Creation of derivative forms of this software for commercial
+// utilization may be subject to restriction; written permission may be
+// obtained from the Trustees of Indiana University.
+// 
+// INDIANA UNIVERSITY AND THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, 
+// EXPRESS OR IMPLIED.  By way of example, but not limitation, INDIANA 
+// UNIVERSITY MAKES NO REPRESENTATIONS OR WARRANTIES OF MERCANTABILITY OR 
+// FITNESS FOR ANY PARTICULAR PURPOSE OR THAT THE USE OF THIS SOFTWARE OR 
+// DOCUMENTATION WILL NOT INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS, 
+// OR OTHER RIGHTS.  Neither Indiana University nor the authors shall be 
+// held liable for any liability with respect to any claim by the user or 
+
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+#include "IUAmpTools/BinnedDataReader.h"
+#include "IUAmpTools/AmpVecs.h"
+
+#include "IUAmpTools/report.h"
+const char* BinnedDataReader::kModule = "BinnedDataReader";
+
+map< string, vector< AmpVecs* > > BinnedDataReader::m_bins;
+
+BinnedDataReader::BinnedDataReader( const vector< string >& args ) :
+UserDataReader< BinnedDataReader >( args ),
+m_ampVecs( NULL ),
+m_iEvent( 0 )
+{
+  assert( args.size() == 2 );
+  
+  unsigned int iBin = atoi( args[1].c_str() );
+  
+  map< string, vector< AmpVecs* > >::iterator split = m_bins.find( args[0] );
+  
+  if( split == m_bins.end() || iBin >= split->second.size() ){
+    
+    report( ERROR, kModule ) << "There is no bin " << args[1] << " for the split "
+    << args[0] << ".  BinnedDataReader::split must be called first." << endl;
+    assert( false );
+  }
+  
+  // share the four-vectors so that the reader is not affected if the
+  // split is cleared or replaced
+  m_ampVecs = new AmpVecs;
+  if( split->second[iBin]->m_dataLoaded )
+    split->second[iBin]->shareDataWith( m_ampVecs );
+}
+
+BinnedDataReader::~BinnedDataReader(){
+  
+  if( m_ampVecs != NULL ) delete m_ampVecs;
+}
+
+Kinematics*
+BinnedDataReader::getEvent(){
+  
+  if( m_iEvent >= m_ampVecs->m_iNTrueEvents ) return NULL;
+  
+  return m_ampVecs->getEvent( m_iEvent++ );
+}
+
+unsigned int
+BinnedDataReader::numEvents() const {
+  
+  return m_ampVecs->m_iNTrueEvents;
+}
+
+unsigned int
+BinnedDataReader::numParticles() const {
+  
+  return m_ampVecs->m_iNParticles;
+}
+
+unsigned long long
+BinnedDataReader::readEvents( GDouble* pdData, GDouble* pdWeights,
+                              unsigned long long maxEvents ){
+  
+  unsigned long long nEvents = m_ampVecs->m_iNTrueEvents - m_iEvent;
+  if( nEvents > maxEvents ) nEvents = maxEvents;
+  
+  unsigned int nValues = 4 * m_ampVecs->m_iNParticles;
+  
+  memcpy( pdData, m_ampVecs->m_pdData + nValues * m_iEvent,
+          nValues * nEvents * sizeof( GDouble ) );
+  memcpy( pdWeights, m_ampVecs->m_pdWeights + m_iEvent,
+          nEvents * sizeof( GDouble ) );
+  
+  m_iEvent += nEvents;
+  
+  return nEvents;
+}
+
+string
+BinnedDataReader::cacheIdentifier() const {
+  
+  ostringstream id;
+  id << identifier() << "%%" << hex << m_ampVecs->dataHash();
+  
+  return id.str();
+}
+
+unsigned int
+BinnedDataReader::numBins( const string& label ){
+  
+  map< string, vector< AmpVecs* > >::iterator split = m_bins.find( label );
+  
+  return( split == m_bins.end() ? 0 : split->second.size() );
+}
+
+unsigned long long
+BinnedDataReader::numEvents( const string& label, unsigned int iBin ){
+  
+  map< string, vector< AmpVecs* > >::iterator split = m_bins.find( label );
+  
+  if( split == m_bins.end() || iBin >= split->second.size() ) return 0;
+  
+  return split->second[iBin]->m_iNTrueEvents;
+}
+
+void
+BinnedDataReader::clear( const string& label ){
+  
+  map< string, vector< AmpVecs* > >::iterator split = m_bins.find( label );
+  if( split == m_bins.end() ) return;
+  
+  // deleting the AmpVecs hands the four-vectors to any readers
+  // that share them
+  for( vector< AmpVecs* >::iterator bin = split->second.begin();
+       bin != split->second.end(); ++bin ){
+    
+    delete *bin;
+  }
+  
+  m_bins.erase( split );
+}
+
+void
+BinnedDataReader::storeBins( const string& label, unsigned int nParticles,
+                             vector< vector< GDouble > >& data,
+                             vector< vector< GDouble > >& weights ){
+  
+  clear( label );
+  
+  vector< AmpVecs* >& bins = m_bins[label];
+  
+  for( unsigned int iBin = 0; iBin < data.size(); ++iBin ){
+    
+    AmpVecs* ampVecs = new AmpVecs;
+    unsigned long long nEvents = weights[iBin].size();
+    
+    if( nEvents > 0 ){
+      
+      GDouble* pdData = new GDouble[data[iBin].size()];
+      GDouble* pdWeights = new GDouble[nEvents];
+      
+      memcpy( pdData, &(data[iBin][0]), data[iBin].size() * sizeof( GDouble ) );
+      memcpy( pdWeights, &(weights[iBin][0]), nEvents * sizeof( GDouble ) );
+      
+      // free the memory for this bin before moving to the next one
+      vector< GDouble >().swap( data[iBin] );
+      vector< GDouble >().swap( weights[iBin] );
+      
+      ampVecs->adoptData( pdData, pdWeights, nEvents, nParticles );
+    }
+    
+    report( INFO, kModule ) << "Bin " << iBin << " of " << label << " has "
+    << nEvents << " events." << endl;
+    
+    bins.push_back( ampVecs );
+  }
+}
@@ -0,0 +1,198 @@
+#if !defined(BINNEDDATAREADER)
+#define BINNEDDATAREADER
+
+//******************************************************************************
+// This file is part of AmpTools, a package for performing Amplitude Analysis
+// 
+// Copyright Trustees of Indiana University 2010, all rights reserved
+// 
+// This software written by Matthew Shepherd, Ryan Mitchell, and 
+//                  Hrayr Matevosyan at Indiana University, Bloomington
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice and author attribution, this list of conditions and the
+//    following disclaimer. 
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice and author attribution, this list of conditions and the
+//    following disclaimer in the documentation and/or other materials
+//    provided with the distribution.
+// 3. Neither the name of the University nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// 
+// Creation of derivative forms of this software for commercial
+// utilization may be subject to restriction; written permission may be
+// obtained from the Trustees of Indiana University.
+// 
+// INDIANA UNIVERSITY AND THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, 
+// EXPRESS OR IMPLIED.  By way of example, but not limitation, INDIANA 
+// UNIVERSITY MAKES NO REPRESENTATIONS OR WARRANTIES OF MERCANTABILITY OR 
+// FITNESS FOR ANY PARTICULAR PURPOSE OR THAT THE USE OF THIS SOFTWARE OR 
+// DOCUMENTATION WILL NOT INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS, 
+// OR OTHER RIGHTS.  Neither Indiana University nor the authors shall be 
+// held liable for any liability with respect to any claim by the user or 
+
+#include <string>
+#include <vector>
+#include <map>
+
+#include "IUAmpTools/UserDataReader.h"
+#include "IUAmpTools/Kinematics.h"
+#include "GPUManager/GPUCustomTypes.h"
+
+class AmpVecs;
+
+using namespace std;
+
+/**
+ * This class splits a data source into bins in a single pass over the
+ * source and then serves each bin to a fit as an ordinary data reader.
+ * It is useful for campaigns of independent fits in bins of, e.g., mass
+ * or momentum transfer, where each source would otherwise be read once
+ * per bin or split into separate files beforehand.
+ *
+ * The splitting is done in the user's program before the fits are set up:
+ *
+ *     BinnedDataReader::split( "data", dataReader, nBins,
+ *       []( const Kinematics& event ){ return massBin( event ); } );
+ *
+ * where the function returns the bin for an event, or a negative number
+ * to skip it.  The events for each bin are held in memory.  After
+ * registering this reader with the AmpToolsInterface, a configuration
+ * file can then refer to a bin by the label and bin number:
+ *
+ *     data  myReaction BinnedDataReader data 7
+ *
+ * Each source (data, background, accepted and generated MC) should be
+ * split with a different label.
+ *
+ * \ingroup IUAmpTools
+ */
+
+class BinnedDataReader : public UserDataReader< BinnedDataReader >
+{
+  
+public:
+  
+  BinnedDataReader() : UserDataReader< BinnedDataReader >(),
+  m_ampVecs( NULL ), m_iEvent( 0 ) {}
+  
+  /**
+   * The constructor takes two arguments:  the label that was used to
+   * split the source and the bin number.
+   */
+  BinnedDataReader( const vector< string >& args );
+  
+  ~BinnedDataReader();
+  
+  string name() const { return "BinnedDataReader"; }
+  
+  Kinematics* getEvent();
+  void resetSource() { m_iEvent = 0; }
+  unsigned int numEvents() const;
+  
+  bool hasBulkRead() const { return true; }
+  bool isThreadSafe() const { return true; }
+  unsigned int numParticles() const;
+  unsigned long long readEvents( GDouble* pdData, GDouble* pdWeights,
+                                 unsigned long long maxEvents );
+  
+  // the contents of a bin depend on the split done by this job
+  // so the identifier alone is not enough for the AmpVecs cache
+  string cacheIdentifier() const;
+  
+  /**
+   * This reads all events from the source once and sorts them into
+   * bins using the function.  Any previous split with the same label
+   * is discarded.  Data readers for the bins that have already been
+   * created keep the events that they were created with.
+   *
+   * \param[in] label the name used to refer to this split
+   * \param[in] source the data reader to split
+   * \param[in] nBins the number of bins
+   * \param[in] binFunction a callable object that takes a const reference
+   * to a Kinematics object and returns an int, the bin number of the event
+   * or a negative number if the event is not used in any bin
+   */
+  template< class F >
+  static void split( const string& label, DataReader* source,
+                     unsigned int nBins, const F& binFunction );
+  
+  /**
+   * Returns the number of bins in a split, or zero if there is
+   * no split with the label.
+   */
+  static unsigned int numBins( const string& label );
+  
+  /**
+   * Returns the number of events in a bin of a split, or zero if
+   * there is no such bin.
+   */
+  static unsigned long long numEvents( const string& label, unsigned int iBin );
+  
+  /**
+   * Frees the memory for the split.  Data readers that have already been
+   * created for the bins share the four-vectors and keep them.
+   */
+  static void clear( const string& label );
+  
+private:
+  
+  static void storeBins( const string& label, unsigned int nParticles,
+                         vector< vector< GDouble > >& data,
+                         vector< vector< GDouble > >& weights );
+  
+  AmpVecs* m_ampVecs;
+  unsigned long long m_iEvent;
+  
+  static map< string, vector< AmpVecs* > > m_bins;
+  
+  static const char* kModule;
+};
+
+template< class F >
+void
+BinnedDataReader::split( const string& label, DataReader* source,
+                         unsigned int nBins, const F& binFunction ){
+  
+  vector< vector< GDouble > > data( nBins );
+  vector< vector< GDouble > > weights( nBins );
+  unsigned int nParticles = 0;
+  
+  source->resetSource();
+  unsigned long long nEvents = source->numEvents();
+  
+  for( unsigned long long iEvent = 0; iEvent < nEvents; ++iEvent ){
+    
+    Kinematics* event = source->getEvent();
+    if( event == NULL ) break;
+    
+    int iBin = binFunction( *event );
+    
+    if( iBin >= 0 && iBin < (int)nBins ){
+      
+      const vector< TLorentzVector >& particles = event->particleList();
+      nParticles = particles.size();
+      
+      for( vector< TLorentzVector >::const_iterator p4 = particles.begin();
+           p4 != particles.end(); ++p4 ){
+        
+        data[iBin].push_back( p4->E() );
+        data[iBin].push_back( p4->Px() );
+        data[iBin].push_back( p4->Py() );
+        data[iBin].push_back( p4->Pz() );
+      }
+      
+      weights[iBin].push_back( event->weight() );
+    }
+    
+    delete event;
+  }
+  
+  storeBins( label, nParticles, data, weights );
+}
+
+#endif
@@ -0,0 +1,94 @@
+#if !(defined COUNTERRANDOM)
+#define COUNTERRANDOM
+
+//******************************************************************************
+// This file is part of AmpTools, a package for performing Amplitude Analysis
+// 
+// Copyright Trustees of Indiana University 2010, all rights reserved
+// 
+// This software written by Matthew Shepherd, Ryan Mitchell, and 
+//                  Hrayr Matevosyan at Indiana University, Bloomington
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice and author attribution, this list of conditions and the
+//    following disclaimer. 
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice and author attribution, this list of conditions and the
+//    following disclaimer in the documentation and/or other materials
+//    provided with the distribution.
+// 3. Neither the name of the University nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// 
+// Creation of derivative forms of this software for commercial
+// utilization may be subject to restriction; written permission may be
+// obtained from the Trustees of Indiana University.
+// 
+// INDIANA UNIVERSITY AND THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, 
+// EXPRESS OR IMPLIED.  By way of example, but not limitation, INDIANA 
+// UNIVERSITY MAKES NO REPRESENTATIONS OR WARRANTIES OF MERCANTABILITY OR 
+// FITNESS FOR ANY PARTICULAR PURPOSE OR THAT THE USE OF THIS SOFTWARE OR 
+// DOCUMENTATION WILL NOT INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS, 
+// OR OTHER RIGHTS.  Neither Indiana University nor the authors shall be 
+// held liable for any liability with respect to any claim by the user or 
+// any other party arising from use of the program.
+
+/**
+ * A counter-based random number generator.  Each number is a hash of
+ * a seed, a stream, a substream, and the position of the number in the
+ * stream, so the numbers for a stream do not depend on how many other
+ * streams were used before it or on which thread uses it.  Giving each
+ * event its own stream makes a calculation reproducible for a given
+ * seed regardless of how the events are divided among threads.
+ *
+ * The hash is the finalizer of the SplitMix64 generator, which is fast
+ * and passes standard statistical tests, but it is not suitable for
+ * cryptographic use.
+ *
+ * \ingroup IUAmpTools
+ */
+
+class CounterRandom
+{
+  
+public:
+  
+  CounterRandom( unsigned long long seed, unsigned long long stream,
+                 unsigned long long substream = 0 ) :
+  m_key( mix( seed ^ mix( stream ^ mix( substream ) ) ) ),
+  m_counter( 0 ) {}
+  
+  /**
+   * Returns the next 64 random bits of the stream.
+   */
+  unsigned long long next() { return mix( m_key + mix( m_counter++ ) ); }
+  
+  /**
+   * Returns the next number of the stream uniformly distributed in [0,1).
+   */
+  double uniform() { return ( next() >> 11 ) * ( 1.0 / 9007199254740992.0 ); }
+  
+  /**
+   * Returns the next number of the stream uniformly distributed in [low,high).
+   */
+  double uniform( double low, double high ) {
+    return low + ( high - low ) * uniform(); }
+  
+private:
+  
+  static unsigned long long mix( unsigned long long z ){
+    
+    z += 0x9e3779b97f4a7c15ULL;
+    z = ( z ^ ( z >> 30 ) ) * 0xbf58476d1ce4e5b9ULL;
+    z = ( z ^ ( z >> 27 ) ) * 0x94d049bb133111ebULL;
+    return z ^ ( z >> 31 );
+  }
+  
+  unsigned long long m_key;
+  unsigned long long m_counter;
+};
+
+#endif
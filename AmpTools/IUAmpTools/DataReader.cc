@@ -38,6 +38,8 @@
 #include <string>
 #include <vector>
 
+#include <sys/stat.h>
+
 #include "IUAmpTools/DataReader.h"
 
 using namespace std;
@@ -59,3 +61,20 @@ DataReader::identifier() const {
   
   return id;
 }
+
+vector< string >
+DataReader::sourceFiles() const {
+  
+  vector< string > files;
+  
+  vector< string > args = arguments();
+  for( vector< string >::const_iterator arg = args.begin();
+      arg != args.end(); ++arg ){
+    
+    struct stat fileStat;
+    if( stat( arg->c_str(), &fileStat ) == 0 && S_ISREG( fileStat.st_mode ) )
+      files.push_back( *arg );
+  }
+  
+  return files;
+}
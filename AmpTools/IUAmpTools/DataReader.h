@@ -40,6 +40,8 @@
 #include <string>
 #include <vector>
 
+#include "GPUManager/GPUCustomTypes.h"
+
 using namespace std;
 
 class Kinematics;
@@ -118,6 +120,57 @@ public:
    */
   virtual unsigned int numEvents() const = 0;
   
+  /**
+   * The user can optionally override this function to return true if the
+   * data reader is able to fill arrays of four-vectors and weights
+   * directly with readEvents.  This avoids the creation of a Kinematics
+   * object for every event when the data are loaded.  If this returns
+   * true then numParticles and readEvents must also be overridden.
+   *
+   * In an MPI job only the leader reads the data from the source,
+   * see DataReaderMPI.
+   *
+   * \see readEvents
+   */
+  virtual bool hasBulkRead() const { return false; }
+  
+  /**
+   * The number of final state particles in each event, which is only
+   * used if hasBulkRead returns true.
+   */
+  virtual unsigned int numParticles() const { return 0; }
+  
+  /**
+   * The user can optionally override this function to return true if
+   * different instances of the data reader can read from their sources
+   * at the same time in different threads.  Readers that use ROOT, for
+   * example, should only return true if ROOT::EnableThreadSafety() has
+   * been called.  Readers that return false (the default) are loaded
+   * one at a time by AmpVecs::preloadData.
+   *
+   * \see AmpToolsInterface::setPreloadThreads
+   */
+  virtual bool isThreadSafe() const { return false; }
+  
+  /**
+   * If hasBulkRead returns true, this function is used to load the data.
+   * It should fill the arrays with at most maxEvents events, starting
+   * with the next event in the source, and return the number of events
+   * that were filled.  The four-vectors for event i and particle j
+   * should be stored as E, px, py, pz starting at
+   * pdData[4*numParticles()*i+4*j] and the weight at pdWeights[i].
+   * The function will be called repeatedly after resetSource until
+   * numEvents events have been read.
+   *
+   * \param[out] pdData the array of four-vectors to fill
+   * \param[out] pdWeights the array of weights to fill
+   * \param[in] maxEvents the maximum number of events to fill
+   *
+   * \see hasBulkRead
+   */
+  virtual unsigned long long readEvents( GDouble* pdData, GDouble* pdWeights,
+                                         unsigned long long maxEvents ){ return 0; }
+  
   /**
    * The user should override this function with one that returns the 
    * class name of the derived data reader.
@@ -132,6 +185,27 @@ public:
    */
   string identifier() const;
   
+  /**
+   * This method returns the string that is used to identify a binary copy
+   * of the data in the AmpVecs cache.  It is the identifier by default
+   * and only needs to be overridden if instances with the same identifier
+   * can provide different events, e.g., in an MPI job.
+   *
+   * \see AmpVecs::setCacheDirectory
+   */
+  virtual string cacheIdentifier() const { return identifier(); }
+  
+  /**
+   * This method returns the files that the data are read from.  The size
+   * and modification time of each file are recorded in the AmpVecs cache
+   * so that a cached copy is not used once the source has changed.  By
+   * default it returns every argument that names an existing file, which
+   * the user can override if the sources are given in some other way.
+   *
+   * \see AmpVecs::setCacheDirectory
+   */
+  virtual vector< string > sourceFiles() const;
+  
   /**
    * This method is overridden by the UserDataReader class and does not
    * need to be defined (or used) by the user.
@@ -0,0 +1,154 @@
+#if !defined(EVENTLOOPTHREADS)
+#define EVENTLOOPTHREADS
+
+
+//******************************************************************************
+// This file is part of AmpTools, a package for performing Amplitude Analysis
+//
+// Copyright Trustees of Indiana University 2010, all rights reserved
+//
+// This software written by Matthew Shepherd, Ryan Mitchell, and
+//                  Hrayr Matevosyan at Indiana University, Bloomington
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice and author attribution, this list of conditions and the
+//    following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice and author attribution, this list of conditions and the
+//    following disclaimer in the documentation and/or other materials
+//    provided with the distribution.
+// 3. Neither the name of the University nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// Creation of derivative forms of this software for commercial
+// utilization may be subject to restriction; written permission may be
+// obtained from the Trustees of Indiana University.
+//
+// INDIANA UNIVERSITY AND THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES,
+// EXPRESS OR IMPLIED.  By way of example, but not limitation, INDIANA
+// UNIVERSITY MAKES NO REPRESENTATIONS OR WARRANTIES OF MERCANTABILITY OR
+// FITNESS FOR ANY PARTICULAR PURPOSE OR THAT THE USE OF THIS SOFTWARE OR
+// DOCUMENTATION WILL NOT INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS,
+// OR OTHER RIGHTS.  Neither Indiana University nor the authors shall be
+// held liable for any liability with respect to any claim by the user or
+// any other party arising from use of the program.
+//******************************************************************************
+
+#include <vector>
+#include <thread>
+
+using namespace std;
+
+/**
+ * This class provides a minimal mechanism for splitting the CPU loops
+ * over events in the framework into contiguous blocks that are processed
+ * by a set of threads.  It is intended to allow a hybrid mode of running
+ * where there is one MPI process per node (or socket) and the cores of
+ * that node are utilized by threads, rather than one MPI process per core.
+ * This saves memory since there is only one copy of the configuration,
+ * managers, and normalization integrals per node and reduces the number
+ * of processes that participate in each MPI collective operation.
+ *
+ * By default only one thread is used and the behavior of the code is
+ * identical to the serial version.  When more than one thread is requested
+ * each thread accumulates a partial result for its block of events and
+ * these partial results are combined in block order by the calling thread.
+ * For a fixed number of threads the result is therefore reproducible.
+ *
+ * Note that when more than one thread is used the calcAmplitude and
+ * calcUserVars methods of user-defined amplitudes will be called
+ * concurrently for different events and should not modify any
+ * shared state.
+ *
+ * \ingroup IUAmpTools
+ */
+
+class EventLoopThreads
+{
+  
+public:
+  
+  /**
+   * Set the number of threads to use for event loops.  A value of zero
+   * will use the number of hardware threads available on the machine.
+   *
+   * \param[in] nThreads the number of threads
+   */
+  static void setNumThreads( unsigned int nThreads );
+  
+  /**
+   * Returns the number of threads that have been requested for event loops.
+   */
+  static unsigned int numThreads() { return m_numThreads; }
+  
+  /**
+   * Returns the number of blocks that a loop over nEvents will be split
+   * into.  Blocks smaller than a minimum size are not worth the overhead
+   * of starting a thread so small loops will have fewer blocks than
+   * the number of threads.
+   *
+   * \param[in] nEvents the number of events in the loop
+   */
+  static unsigned int numBlocks( unsigned long nEvents );
+  
+  /**
+   * This executes func( iBlock, firstEvent, lastEvent ) for each block of
+   * events, where the loop should run from firstEvent up to but not including
+   * lastEvent.  The first block is processed by the calling thread and the
+   * call returns once all blocks have been processed.
+   *
+   * \param[in] nEvents the number of events in the loop
+   * \param[in] func a callable object with the signature above
+   */
+  template< class F >
+  static void run( unsigned long nEvents, const F& func );
+  
+private:
+  
+  static unsigned int m_numThreads;
+  static const unsigned long kMinEventsPerBlock;
+};
+
+template< class F >
+void
+EventLoopThreads::run( unsigned long nEvents, const F& func ){
+  
+  unsigned int nBlocks = numBlocks( nEvents );
+  
+  if( nBlocks <= 1 ){
+    
+    func( 0, 0, nEvents );
+    return;
+  }
+  
+  unsigned long blockSize = nEvents / nBlocks;
+  unsigned long remainder = nEvents % nBlocks;
+  
+  vector< unsigned long > first( nBlocks + 1, 0 );
+  for( unsigned int i = 0; i < nBlocks; ++i ){
+    
+    first[i+1] = first[i] + blockSize + ( i < remainder ? 1 : 0 );
+  }
+  
+  vector< thread > workers;
+  workers.reserve( nBlocks - 1 );
+  
+  for( unsigned int i = 1; i < nBlocks; ++i ){
+    
+    workers.push_back( thread( func, i, first[i], first[i+1] ) );
+  }
+  
+  func( 0, first[0], first[1] );
+  
+  for( vector< thread >::iterator worker = workers.begin();
+       worker != workers.end(); ++worker ){
+    
+    worker->join();
+  }
+}
+
+#endif
@@ -0,0 +1,77 @@
+#if !(defined EVENTSINK)
+#define EVENTSINK
+
+//******************************************************************************
+// This file is part of AmpTools, a package for performing Amplitude Analysis
+// 
+// Copyright Trustees of Indiana University 2010, all rights reserved
+// 
+// This software written by Matthew Shepherd, Ryan Mitchell, and 
+//                  Hrayr Matevosyan at Indiana University, Bloomington
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice and author attribution, this list of conditions and the
+//    following disclaimer. 
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice and author attribution, this list of conditions and the
+//    following disclaimer in the documentation and/or other materials
+//    provided with the distribution.
+// 3. Neither the name of the University nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// 
+// Creation of derivative forms of this software for commercial
+// utilization may be subject to restriction; written permission may be
+// obtained from the Trustees of Indiana University.
+// 
+// INDIANA UNIVERSITY AND THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, 
+// EXPRESS OR IMPLIED.  By way of example, but not limitation, INDIANA 
+// UNIVERSITY MAKES NO REPRESENTATIONS OR WARRANTIES OF MERCANTABILITY OR 
+// FITNESS FOR ANY PARTICULAR PURPOSE OR THAT THE USE OF THIS SOFTWARE OR 
+// DOCUMENTATION WILL NOT INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS, 
+// OR OTHER RIGHTS.  Neither Indiana University nor the authors shall be 
+// held liable for any liability with respect to any claim by the user or 
+// any other party arising from use of the program.
+//******************************************************************************
+
+#include "GPUManager/GPUCustomTypes.h"
+
+/**
+ * An interface for writing batches of events, which the user
+ * implements for a particular output format.  It is used by the classes
+ * that stream events, MCGenerator and IntensityWeighter.  These call
+ * writeEvents from a separate thread, but never concurrently with itself,
+ * so that the output overlaps with the processing of the next batch.
+ * IntensityWeighter only does this if its DataReader reports that it is
+ * thread safe and otherwise writes each batch before reading the next.
+ * A sink that uses ROOT while other ROOT objects are in use on the main
+ * thread requires ROOT::EnableThreadSafety() to have been called.
+ *
+ * \ingroup IUAmpTools
+ */
+
+class EventSink
+{
+  
+public:
+  
+  virtual ~EventSink() {}
+  
+  /**
+   * Write a batch of events.
+   *
+   * \param[in] fourVecs E, px, py, pz for each particle of each event,
+   *   in the layout of AmpVecs::m_pdData
+   * \param[in] weights the weight of each event
+   * \param[in] nEvents the number of events in the batch
+   * \param[in] nParticles the number of particles in each event
+   */
+  virtual void writeEvents( const GDouble* fourVecs, const GDouble* weights,
+                            unsigned long long nEvents,
+                            unsigned int nParticles ) = 0;
+};
+
+#endif
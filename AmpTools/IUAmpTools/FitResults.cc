@@ -35,10 +35,16 @@
 //******************************************************************************
 
 #include <iostream>
+#include <fstream>
+#include <sstream>
 #include <algorithm>
 #include <cmath>
 #include <iomanip>
 #include <cassert>
+#include <cstdio>
+#include <cstring>
+
+#include <unistd.h>
 
 #include "IUAmpTools/FitResults.h"
 #include "IUAmpTools/ConfigFileParser.h"
@@ -48,6 +54,79 @@
 
 const char* FitResults::kModule = "FitResults";
 
+// A binary file starts with this header and is followed by the records
+// for each result.  Each record has a record header that gives the lengths
+// of three blocks:  the likelihood, fitter, and parameter information that
+// is read when the record is loaded, the normalization integrals for all
+// reactions, and the text of the configuration.  The last two are read only
+// when they are needed.  After the records is an index of the offset of
+// each record from the start of the file followed by the trailer.
+
+struct FitResultsFileHeader {
+  
+  char magic[8];
+  unsigned int version;
+  unsigned int unused;
+};
+
+struct FitResultsRecordHeader {
+  
+  unsigned long long infoLength;
+  unsigned long long normIntLength;
+  unsigned long long cfgLength;
+};
+
+struct FitResultsFileTrailer {
+  
+  unsigned long long numResults;
+  unsigned long long indexOffset;
+  char magic[8];
+};
+
+static const char kFitResultsMagic[8] = { 'A', 'M', 'P', 'F', 'I', 'T', 'R', '\0' };
+static const unsigned int kFitResultsVersion = 2;
+
+// helpers for writing and reading the binary records
+
+template< class T >
+static void writeBinary( ostream& out, const T& value ){
+  
+  out.write( reinterpret_cast< const char* >( &value ), sizeof( T ) );
+}
+
+static void writeBinary( ostream& out, const string& value ){
+  
+  writeBinary( out, (unsigned int)value.size() );
+  out.write( value.data(), value.size() );
+}
+
+template< class T >
+static void readBinary( const char*& pos, T& value ){
+  
+  memcpy( &value, pos, sizeof( T ) );
+  pos += sizeof( T );
+}
+
+static void readBinary( const char*& pos, string& value ){
+  
+  unsigned int length;
+  readBinary( pos, length );
+  value.assign( pos, length );
+  pos += length;
+}
+
+static bool readBlock( const string& fileName, unsigned long long offset,
+                       unsigned long long length, vector< char >& buffer ){
+  
+  ifstream input( fileName.c_str(), ios::in | ios::binary );
+  input.seekg( offset );
+  
+  buffer.resize( length );
+  input.read( &(buffer[0]), length );
+  
+  return !input.fail();
+}
+
 #ifndef __ACLIC__
 
 #include "IUAmpTools/AmplitudeManager.h"
@@ -71,7 +150,9 @@ m_minManager( minManager ),
 m_parManager( parManager ),
 m_createdFromFile( false ),
 m_warnedAboutFreeParams( false ),
-m_isValid( true ){
+m_isValid( true ),
+m_normIntLength( 0 ),
+m_cfgLength( 0 ){
   
 }
 
@@ -81,11 +162,23 @@ m_isValid( true ){
 FitResults::FitResults( const string& inFile, bool muteWarning ) :
 m_createdFromFile( true ),
 m_warnedAboutFreeParams( muteWarning ),
-m_isValid( false ){
+m_isValid( false ),
+m_normIntLength( 0 ),
+m_cfgLength( 0 ){
   
   loadResults( inFile );
 }
 
+FitResults::FitResults( const string& inFile, unsigned int index, bool muteWarning ) :
+m_createdFromFile( true ),
+m_warnedAboutFreeParams( muteWarning ),
+m_isValid( false ),
+m_normIntLength( 0 ),
+m_cfgLength( 0 ){
+  
+  loadBinaryResults( inFile, index );
+}
+
 FitResults::~FitResults() {
   
   if( m_createdFromFile ) {
@@ -131,6 +224,8 @@ FitResults::intensity( const string& amplitude, bool accCorrected ) const {
 pair< double, double >
 FitResults::intensity( const vector< string >& amplitudes, bool accCorrected ) const {
   
+  loadNormInts();
+  
   // first make sure we know about all the amplitudes:
   vector< string > knownAmps = ampList();
   for( vector< string >::const_iterator amp = amplitudes.begin();
@@ -379,6 +474,8 @@ FitResults::phaseDiff( const string& amp1, const string& amp2 ) const {
 const NormIntInterface*
 FitResults::normInt( const string& reactionName ) const {
   
+  loadNormInts();
+  
   map< string, NormIntInterface* >::const_iterator nameNormInt =
   m_normIntMap.find( reactionName );
   
@@ -487,6 +584,20 @@ FitResults::ampParMap() const {
   
   map< string, double > parMap;
   
+  // a binary record stores the names so that the configuration
+  // does not need to be parsed just to look them up
+  if( m_cfgLength != 0 ){
+    
+    for( vector< string >::const_iterator name = m_ampParNames.begin();
+        name != m_ampParNames.end(); ++name ){
+      
+      parMap[*name] = parValue( *name );
+    }
+    
+    return parMap;
+  }
+  
+  loadConfigInfo();
   vector< ParameterInfo* > parList = m_cfgInfo->parameterList();
   
   for( vector< ParameterInfo* >::iterator par = parList.begin();
@@ -624,6 +735,9 @@ FitResults::ampList( const string& reaction ) const {
 void
 FitResults::writeResults( const string& outFile ) const {
   
+  loadNormInts();
+  loadConfigInfo();
+  
   ofstream output( outFile.c_str() );
   
   output.precision( 15 );
@@ -712,6 +826,8 @@ FitResults::writeResults( const string& outFile ) const {
 void
 FitResults::writeSeed( const string& outFile ) const {
   
+  loadConfigInfo();
+  
   ofstream output( outFile.c_str() );
   output.precision( 15 );
   
@@ -777,6 +893,22 @@ FitResults::loadResults( const string& inFile ){
     return;
   }
   
+  // check for a binary file
+  
+  char magic[sizeof( kFitResultsMagic )];
+  input.read( magic, sizeof( magic ) );
+  
+  if( !input.fail() &&
+      memcmp( magic, kFitResultsMagic, sizeof( kFitResultsMagic ) ) == 0 ){
+    
+    input.close();
+    loadBinaryResults( inFile, 0 );
+    return;
+  }
+  
+  input.clear();
+  input.seekg( 0 );
+  
   input.getline( line, kMaxLine ); // top message - verify it is there:
   string lineStr( line );
   if( lineStr.find( outputHeader() ) == string::npos ){
@@ -896,6 +1028,407 @@ FitResults::loadResults( const string& inFile ){
   m_isValid = true;
 }
 
+void
+FitResults::writeBinaryRecord( ostream& output ) const {
+  
+  loadNormInts();
+  loadConfigInfo();
+  
+  ostringstream info;
+  
+  writeBinary( info, m_numReactions );
+  for( int i = 0; i < m_numReactions; ++i ){
+    
+    writeBinary( info, m_reactionNames[i] );
+    writeBinary( info, m_numAmps[i] );
+    
+    for( unsigned int j = 0; j < m_ampNames[i].size(); ++j ){
+      
+      writeBinary( info, m_ampNames[i][j] );
+      writeBinary( info, m_ampScaleNames[i][j] );
+      writeBinary( info, m_ampScaleValues[i][j] );
+    }
+    
+    writeBinary( info, m_likelihoodMap.find( m_reactionNames[i] )->second );
+  }
+  
+  writeBinary( info, m_likelihoodTotal );
+  writeBinary( info, m_lastCommand );
+  writeBinary( info, m_lastCommandStatus );
+  writeBinary( info, m_eMatrixStatus );
+  writeBinary( info, m_precision );
+  writeBinary( info, m_strategy );
+  writeBinary( info, m_estDistToMin );
+  writeBinary( info, m_bestMin );
+  
+  writeBinary( info, (unsigned int)m_parNames.size() );
+  for( unsigned int i = 0; i < m_parNames.size(); ++i ){
+    
+    writeBinary( info, m_parNames[i] );
+    writeBinary( info, m_parValues[i] );
+  }
+  
+  for( unsigned int i = 0; i < m_parNames.size(); ++i ){
+    
+    info.write( reinterpret_cast< const char* >( &(m_covMatrix[i][0]) ),
+                m_parNames.size() * sizeof( double ) );
+  }
+  
+  map< string, double > ampPars = ampParMap();
+  writeBinary( info, (unsigned int)ampPars.size() );
+  for( map< string, double >::const_iterator par = ampPars.begin();
+      par != ampPars.end(); ++par ){
+    
+    writeBinary( info, par->first );
+  }
+  
+  ostringstream normInts;
+  
+  for( unsigned int i = 0; i < m_reactionNames.size(); ++i ){
+    
+    string reac = m_reactionNames[i];
+    const NormIntInterface* ni = m_normIntMap.find(reac)->second;
+    
+#ifndef __ACLIC__
+    if( !m_createdFromFile && ni->hasAccessToMC() ) ni->forceCacheUpdate();
+#endif
+    
+    ostringstream niBlock;
+    ni->exportBinaryNormIntCache( niBlock );
+    
+    writeBinary( normInts, reac );
+    writeBinary( normInts, (unsigned long long)niBlock.str().size() );
+    normInts << niBlock.str();
+  }
+  
+  ostringstream cfg;
+  cfg.precision( 15 );
+  cfg << *m_cfgInfo;
+  
+  FitResultsRecordHeader header;
+  header.infoLength = info.str().size();
+  header.normIntLength = normInts.str().size();
+  header.cfgLength = cfg.str().size();
+  
+  writeBinary( output, header );
+  output << info.str() << normInts.str() << cfg.str();
+}
+
+void
+FitResults::writeBinaryResults( const string& fileName, bool append ) const {
+  
+  ifstream test( fileName.c_str() );
+  bool exists = !test.fail();
+  test.close();
+  
+  if( !append || !exists ){
+    
+    writeBinaryResults( fileName, vector< const FitResults* >( 1, this ) );
+    return;
+  }
+  
+  fstream file( fileName.c_str(), ios::in | ios::out | ios::binary );
+  
+  FitResultsFileTrailer trailer;
+  file.seekg( -(long long)sizeof( trailer ), ios::end );
+  file.read( reinterpret_cast< char* >( &trailer ), sizeof( trailer ) );
+  
+  if( file.fail() ||
+      memcmp( trailer.magic, kFitResultsMagic, sizeof( kFitResultsMagic ) ) != 0 ){
+    
+    report( ERROR, kModule ) << "Cannot append to " << fileName
+    << " since it is not a binary FitResults file." << endl;
+    return;
+  }
+  
+  vector< unsigned long long > index( trailer.numResults + 1 );
+  file.seekg( trailer.indexOffset );
+  file.read( reinterpret_cast< char* >( &(index[0]) ),
+             trailer.numResults * sizeof( unsigned long long ) );
+  
+  // the new record replaces the old index which is then
+  // written again after the record
+  
+  index[trailer.numResults] = trailer.indexOffset;
+  file.seekp( trailer.indexOffset );
+  writeBinaryRecord( file );
+  
+  trailer.indexOffset = file.tellp();
+  trailer.numResults += 1;
+  
+  file.write( reinterpret_cast< const char* >( &(index[0]) ),
+              index.size() * sizeof( unsigned long long ) );
+  writeBinary( file, trailer );
+  
+  if( file.fail() )
+    report( ERROR, kModule ) << "Error appending to " << fileName << endl;
+}
+
+void
+FitResults::writeBinaryResults( const string& fileName,
+                                const vector< const FitResults* >& results ){
+  
+  // write to a temporary file and rename it so that other jobs never
+  // see a partially written file
+  ostringstream tmpName;
+  tmpName << fileName << ".tmp" << getpid();
+  
+  {
+    ofstream output( tmpName.str().c_str(), ios::out | ios::binary );
+    
+    if( !output ){
+      
+      report( ERROR, kModule ) << "Unable to write file " << tmpName.str() << endl;
+      return;
+    }
+    
+    FitResultsFileHeader header;
+    memcpy( header.magic, kFitResultsMagic, sizeof( kFitResultsMagic ) );
+    header.version = kFitResultsVersion;
+    header.unused = 0;
+    writeBinary( output, header );
+    
+    vector< unsigned long long > index;
+    for( vector< const FitResults* >::const_iterator result = results.begin();
+         result != results.end(); ++result ){
+      
+      index.push_back( output.tellp() );
+      (**result).writeBinaryRecord( output );
+    }
+    
+    FitResultsFileTrailer trailer;
+    trailer.numResults = index.size();
+    trailer.indexOffset = output.tellp();
+    memcpy( trailer.magic, kFitResultsMagic, sizeof( kFitResultsMagic ) );
+    
+    if( !index.empty() )
+      output.write( reinterpret_cast< const char* >( &(index[0]) ),
+                    index.size() * sizeof( unsigned long long ) );
+    writeBinary( output, trailer );
+  }
+  
+  if( rename( tmpName.str().c_str(), fileName.c_str() ) != 0 ){
+    
+    report( ERROR, kModule ) << "Unable to rename " << tmpName.str()
+    << " to " << fileName << endl;
+    remove( tmpName.str().c_str() );
+  }
+}
+
+unsigned int
+FitResults::numBinaryResults( const string& fileName ){
+  
+  ifstream input( fileName.c_str(), ios::in | ios::binary );
+  
+  FitResultsFileTrailer trailer;
+  input.seekg( -(long long)sizeof( trailer ), ios::end );
+  input.read( reinterpret_cast< char* >( &trailer ), sizeof( trailer ) );
+  
+  if( input.fail() ||
+      memcmp( trailer.magic, kFitResultsMagic, sizeof( kFitResultsMagic ) ) != 0 )
+    return 0;
+  
+  return trailer.numResults;
+}
+
+void
+FitResults::loadBinaryResults( const string& inFile, unsigned int index ){
+  
+  ifstream input( inFile.c_str(), ios::in | ios::binary );
+  
+  if( input.fail() ){
+    
+    report( ERROR, kModule ) << "FitResults file does not exist: " << inFile << endl;
+    return;
+  }
+  
+  FitResultsFileHeader fileHeader;
+  input.read( reinterpret_cast< char* >( &fileHeader ), sizeof( fileHeader ) );
+  
+  if( input.fail() ||
+      memcmp( fileHeader.magic, kFitResultsMagic, sizeof( kFitResultsMagic ) ) != 0 ||
+      fileHeader.version != kFitResultsVersion ){
+    
+    report( ERROR, kModule ) << "trying to construct a FitResults object from a file " << endl
+    << "         that is not a binary FitResults file.  (Check arguments.)" << endl;
+    assert( false );
+  }
+  
+  FitResultsFileTrailer trailer;
+  input.seekg( -(long long)sizeof( trailer ), ios::end );
+  input.read( reinterpret_cast< char* >( &trailer ), sizeof( trailer ) );
+  
+  if( index >= trailer.numResults ){
+    
+    report( ERROR, kModule ) << "Request for result " << index << " but file "
+    << inFile << " contains only " << trailer.numResults << " results." << endl;
+    return;
+  }
+  
+  unsigned long long offset;
+  input.seekg( trailer.indexOffset + index * sizeof( offset ) );
+  input.read( reinterpret_cast< char* >( &offset ), sizeof( offset ) );
+  
+  FitResultsRecordHeader header;
+  input.seekg( offset );
+  input.read( reinterpret_cast< char* >( &header ), sizeof( header ) );
+  
+  vector< char > buffer( header.infoLength );
+  input.read( &(buffer[0]), header.infoLength );
+  
+  if( input.fail() ){
+    
+    report( ERROR, kModule ) << "Error reading result " << index << " from "
+    << inFile << endl;
+    return;
+  }
+  
+  const char* pos = &(buffer[0]);
+  
+  readBinary( pos, m_numReactions );
+  
+  m_reactionNames.resize( m_numReactions );
+  m_numAmps.resize( m_numReactions );
+  m_ampNames.resize( m_numReactions );
+  m_ampScaleNames.resize( m_numReactions );
+  m_ampScaleValues.resize( m_numReactions );
+  m_ampIndex.resize( m_numReactions );
+  
+  for( int i = 0; i < m_numReactions; ++i ){
+    
+    readBinary( pos, m_reactionNames[i] );
+    readBinary( pos, m_numAmps[i] );
+    
+    m_reacIndex[m_reactionNames[i]] = i;
+    
+    m_ampNames[i].resize( m_numAmps[i] );
+    m_ampScaleNames[i].resize( m_numAmps[i] );
+    m_ampScaleValues[i].resize( m_numAmps[i] );
+    
+    for( unsigned int j = 0; j < m_ampNames[i].size(); ++j ){
+      
+      readBinary( pos, m_ampNames[i][j] );
+      readBinary( pos, m_ampScaleNames[i][j] );
+      readBinary( pos, m_ampScaleValues[i][j] );
+      
+      m_ampIndex[i][m_ampNames[i][j]] = j;
+    }
+    
+    readBinary( pos, m_likelihoodMap[m_reactionNames[i]] );
+  }
+  
+  readBinary( pos, m_likelihoodTotal );
+  readBinary( pos, m_lastCommand );
+  readBinary( pos, m_lastCommandStatus );
+  readBinary( pos, m_eMatrixStatus );
+  readBinary( pos, m_precision );
+  readBinary( pos, m_strategy );
+  readBinary( pos, m_estDistToMin );
+  readBinary( pos, m_bestMin );
+  
+  unsigned int nPar;
+  readBinary( pos, nPar );
+  
+  m_parNames.resize( nPar );
+  m_parValues.resize( nPar );
+  m_covMatrix.resize( nPar );
+  
+  for( unsigned int i = 0; i < nPar; ++i ){
+    
+    readBinary( pos, m_parNames[i] );
+    readBinary( pos, m_parValues[i] );
+    m_parIndex[m_parNames[i]] = i;
+  }
+  
+  for( unsigned int i = 0; i < nPar; ++i ){
+    
+    m_covMatrix[i].resize( nPar );
+    memcpy( &(m_covMatrix[i][0]), pos, nPar * sizeof( double ) );
+    pos += nPar * sizeof( double );
+  }
+  
+  unsigned int nAmpPar;
+  readBinary( pos, nAmpPar );
+  
+  m_ampParNames.resize( nAmpPar );
+  for( unsigned int i = 0; i < nAmpPar; ++i ){
+    
+    readBinary( pos, m_ampParNames[i] );
+  }
+  
+  assert( pos == &(buffer[0]) + header.infoLength );
+  
+  // record where to find the rest for later
+  
+  m_binaryFile = inFile;
+  m_normIntOffset = offset + sizeof( header ) + header.infoLength;
+  m_normIntLength = header.normIntLength;
+  m_cfgOffset = m_normIntOffset + header.normIntLength;
+  m_cfgLength = header.cfgLength;
+  
+  m_isValid = true;
+}
+
+void
+FitResults::loadNormInts() const {
+  
+  if( m_normIntLength == 0 ) return;
+  
+  vector< char > buffer;
+  if( !readBlock( m_binaryFile, m_normIntOffset, m_normIntLength, buffer ) ){
+    
+    report( ERROR, kModule ) << "Unable to read normalization integrals from "
+    << m_binaryFile << endl;
+    assert( false );
+  }
+  
+  const char* pos = &(buffer[0]);
+  const char* end = pos + buffer.size();
+  
+  while( pos < end ){
+    
+    string reac;
+    unsigned long long length;
+    
+    readBinary( pos, reac );
+    readBinary( pos, length );
+    
+    NormIntInterface* ni = new NormIntInterface();
+    if( !ni->loadBinaryNormIntCache( pos, length ) ){
+      
+      report( ERROR, kModule ) << "Corrupt normalization integrals for reaction "
+      << reac << " in " << m_binaryFile << endl;
+      assert( false );
+    }
+    
+    m_normIntMap[reac] = ni;
+    pos += length;
+  }
+  
+  m_normIntLength = 0;
+}
+
+void
+FitResults::loadConfigInfo() const {
+  
+  if( m_cfgLength == 0 ) return;
+  
+  vector< char > buffer;
+  if( !readBlock( m_binaryFile, m_cfgOffset, m_cfgLength, buffer ) ){
+    
+    report( ERROR, kModule ) << "Unable to read configuration from "
+    << m_binaryFile << endl;
+    assert( false );
+  }
+  
+  istringstream input( string( buffer.begin(), buffer.end() ) );
+  
+  ConfigFileParser cfgParser( input );
+  m_cfgInfo = cfgParser.getConfigurationInfo();
+  
+  m_cfgLength = 0;
+}
+
 #ifndef __ACLIC__
 
 void
@@ -1004,6 +1537,8 @@ FitResults::rotateResults()
   
   string reactionName;
   
+  loadConfigInfo();
+  
   // loop over the reactions
   vector< ReactionInfo* > reactionInfo = m_cfgInfo->reactionList();
   for( vector< ReactionInfo* >::const_iterator reactionInfoItr = reactionInfo.begin(); reactionInfoItr != reactionInfo.end(); ++reactionInfoItr ){
@@ -112,6 +112,22 @@ public:
    */
   FitResults( const string& inFile, bool muteWarning = false );
   
+  /**
+   * Constructor for accessing one of several results in a binary file.
+   *
+   * This reconstitutes the FitResults object stored at position index
+   * of a file written by writeBinaryResults.  Note that all three
+   * arguments must be given -- with two arguments the constructor
+   * above is used, which loads the first result in a binary file.
+   *
+   * \param[in] inFile the name of the input file
+   * \param[in] index the position of the result in the file
+   * \param[in] muteWarning suppress the warning about floating parameters
+   *
+   * \see numBinaryResults
+   */
+  FitResults( const string& inFile, unsigned int index, bool muteWarning );
+  
   /**
    * The destructor.
    *
@@ -127,7 +143,7 @@ public:
    * Used only for PlotGenerator to contain histograms during
    * event generation.
    */
-  FitResults() {};
+  FitResults() : m_normIntLength( 0 ), m_cfgLength( 0 ) {};
 
   /**
    * A function to test if the FitResults object is valid.  This
@@ -149,7 +165,15 @@ public:
    * Returns a const pointer to the configuration info that is being
    * used in the fit or was read in from the input file.
    */
-  const ConfigurationInfo* configInfo() const { return m_cfgInfo; }
+  const ConfigurationInfo* configInfo() const { loadConfigInfo(); return m_cfgInfo; }
+
+  /**
+   * Returns false while the configuration of a result read from a
+   * binary file has not yet been parsed.  The configuration is only
+   * parsed when it is needed, e.g., by configInfo() or writeResults();
+   * intensities can be computed without it.
+   */
+  bool configInfoLoaded() const { return m_cfgLength == 0; }
   
   /**
    * Return the global likelihood.
@@ -430,6 +454,40 @@ public:
    */
   void writeResults( const string& fileName ) const;
   
+  /**
+   * Writes the current fit results object to a binary file, which is much
+   * faster to read than the text format.  If append is true and the file
+   * already exists the result is added to the end of the file.  A binary
+   * file contains an index so that any one of the results can be read
+   * without reading those before it, and the normalization integrals and
+   * configuration are not read until they are needed, e.g., by a call to
+   * intensity or configInfo.
+   *
+   * Appending reads the index of the file, so when writing a large number
+   * of results it is faster to use the static function below.
+   *
+   * \param[in] fileName the name of the output file
+   * \param[in] append add to the results in an existing file
+   */
+  void writeBinaryResults( const string& fileName, bool append = false ) const;
+  
+  /**
+   * Writes a set of fit results to a single binary file.
+   *
+   * \param[in] fileName the name of the output file
+   * \param[in] results the results to write in order
+   */
+  static void writeBinaryResults( const string& fileName,
+                                  const vector< const FitResults* >& results );
+  
+  /**
+   * Returns the number of results stored in a binary file, or zero if
+   * the file is not a binary FitResults file.
+   *
+   * \param[in] fileName the name of the file
+   */
+  static unsigned int numBinaryResults( const string& fileName );
+  
   /**
    * Writes a file that is useful for seeding the results of subsequent fits.
    * The file contains commands to initalize the production parameters of
@@ -447,6 +505,15 @@ public:
    * \param[in] fileName loadResults
    */
   void loadResults( const string& fileName );
+  
+  /**
+   * Reconstitutes a FitResults object from position index of a binary
+   * file.  As above, users will typically use the constructor instead.
+   *
+   * \param[in] fileName the name of the binary file
+   * \param[in] index the position of the result in the file
+   */
+  void loadBinaryResults( const string& fileName, unsigned int index = 0 );
 
   /**
    * Rotates the results of a fit to have the following phase convention:
@@ -482,6 +549,13 @@ private:
     return "*** DO NOT EDIT THIS FILE - IT IS FORMATTED FOR INPUT ***";
   }
 
+  void writeBinaryRecord( ostream& output ) const;
+  
+  // these read the parts of a binary record that are deferred
+  // until they are needed
+  void loadNormInts() const;
+  void loadConfigInfo() const;
+  
 #ifndef __ACLIC__
   
   void recordAmpSetup();
@@ -526,12 +600,15 @@ private:
   
   map< string, int > m_parIndex;
   
+  // the free amplitude parameters, as stored in a binary record
+  vector< string > m_ampParNames;
+  
   // hold pointers to the classes that are needed to fetch the results
   
-  ConfigurationInfo* m_cfgInfo;
+  mutable ConfigurationInfo* m_cfgInfo;
   vector< IntensityManager* > m_intenManVec;
   map< string, LikelihoodCalculator* > m_likCalcMap;
-  map< string, NormIntInterface* > m_normIntMap;
+  mutable map< string, NormIntInterface* > m_normIntMap;
   MinuitMinimizationManager* m_minManager;
   ParameterManager* m_parManager;
   
@@ -539,6 +616,14 @@ private:
   mutable bool m_warnedAboutFreeParams;
   bool m_isValid;
   
+  // the location of the deferred parts of a binary record -- the
+  // lengths are zero once they have been read
+  string m_binaryFile;
+  unsigned long long m_normIntOffset;
+  mutable unsigned long long m_normIntLength;
+  unsigned long long m_cfgOffset;
+  mutable unsigned long long m_cfgLength;
+  
   static const char* kModule;
 };
 
@@ -91,3 +91,33 @@ Histogram::operator+=( HistStruct& hStruct ){
   
   m_entries += hStruct.entries;
 }
+
+void
+Histogram::operator+=( const Histogram& hist ){
+  
+  assert( hist.m_nBins == m_nBins );
+  
+  for( int i = 0; i < m_nBins; ++i ){
+    
+    m_binContents[i] += hist.m_binContents[i];
+    m_sumWeightSq[i] += hist.m_sumWeightSq[i];
+  }
+  
+  m_entries += hist.m_entries;
+}
+
+void
+Histogram::fillValues( const double* values, double weight ){
+  
+  fill( vector< double >( values, values + m_dimensions ), weight );
+}
+
+void
+Histogram::fillBatch( const double* values, const double* weights,
+                      unsigned long long nEntries ){
+  
+  for( unsigned long long i = 0; i < nEntries; ++i ){
+    
+    fillValues( values + m_dimensions*i, weights[i] );
+  }
+}
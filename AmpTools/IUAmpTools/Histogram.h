@@ -65,6 +65,15 @@ public:
 	virtual ~Histogram(){};
 	/*Pure virtual methods*/
 	virtual void fill( vector< double > value, double weight = 1.0 )= 0;
+  
+  // fill with one value for each dimension of the histogram, which avoids
+  // creating a vector -- the default implementation calls fill above
+  virtual void fillValues( const double* values, double weight = 1.0 );
+  
+  // fill nEntries entries, where the values of entry i start at
+  // values[dimensions()*i] and its weight is weights[i]
+  void fillBatch( const double* values, const double* weights,
+                  unsigned long long nEntries );
 	
 	virtual TH1* toRoot() const=0;
 	virtual HistStruct toStruct() const=0;
@@ -76,6 +85,11 @@ public:
 	void clear();
 	void operator+=( HistStruct& hStruct );
   
+  // add the contents of a histogram with the same binning
+  void operator+=( const Histogram& hist );
+  
+  int dimensions() const { return m_dimensions; }
+  
   string title() const { return m_title; }
   string name()  const { return m_name;  }
   
@@ -91,7 +91,13 @@ Histogram1D::fill( vector < double > values, double weight ){
   
   assert (values.size()==1);	//This is a 1D histogram!
   
-  double value=values.at(0);
+  fillValues( values.data(), weight );
+}
+
+void
+Histogram1D::fillValues( const double* values, double weight ){
+  
+  double value=values[0];
   
   if( ( value < m_xHigh ) && ( value >= m_xLow ) ){
     
@@ -56,6 +56,7 @@ public:
                  string name = "hist1d", string title = "1D Histogram" );
 
     virtual void fill( vector< double > value, double weight = 1.0 );
+    virtual void fillValues( const double* values, double weight = 1.0 );
    
     virtual TH1* toRoot() const;
     virtual HistStruct toStruct() const;
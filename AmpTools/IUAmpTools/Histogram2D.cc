@@ -101,6 +101,13 @@ void
 Histogram2D::fill(vector < double > values, double weight ){
   
   assert (values.size()==2);
+  
+  fillValues( values.data(), weight );
+}
+
+void
+Histogram2D::fillValues( const double* values, double weight ){
+  
   double valueX=values[0];
   double valueY=values[1];
 
@@ -59,6 +59,7 @@ public:
     Histogram2D( HistStruct& hist );
  
     virtual void fill(vector < double > values,double weight = 1.0 );
+    virtual void fillValues( const double* values, double weight = 1.0 );
     virtual TH1* toRoot() const;
     virtual HistStruct toStruct() const;
     virtual Histogram* Clone() const;
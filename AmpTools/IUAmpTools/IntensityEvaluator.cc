@@ -0,0 +1,203 @@
+//******************************************************************************
+// This file is part of AmpTools, a package for performing Amplitude Analysis
+// 
+// Copyright Trustees of Indiana University 2010, all rights reserved
+// 
+// This software written by Matthew Shepherd, Ryan Mitchell, and 
+//                  Hrayr Matevosyan at Indiana University, Bloomington
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice and author attribution, this list of conditions and the
+//    following disclaimer. 
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice and author attribution, this list of conditions and the
+//    following disclaimer in the documentation and/or other materials
+//    provided with the distribution.
+// 3. Neither the name of the University nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// 
+// Creation of derivative forms of this software for commercial
+// utilization may be subject to restriction; written permission may be
+// obtained from the Trustees of Indiana University.
+// 
+// INDIANA UNIVERSITY AND THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, 
+// EXPRESS OR IMPLIED.  By way of example, but not limitation, INDIANA 
+// UNIVERSITY MAKES NO REPRESENTATIONS OR WARRANTIES OF MERCANTABILITY OR 
+// FITNESS FOR ANY PARTICULAR PURPOSE OR THAT THE USE OF THIS SOFTWARE OR 
+// DOCUMENTATION WILL NOT INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS, 
+// OR OTHER RIGHTS.  Neither Indiana University nor the authors shall be 
+// held liable for any liability with respect to any claim by the user or 
+// any other party arising from use of the program.
+//******************************************************************************
+
+#include <cstring>
+#include <cassert>
+
+#include "IUAmpTools/IntensityEvaluator.h"
+#include "IUAmpTools/IntensityManager.h"
+#include "IUAmpTools/AmpToolsInterface.h"
+#include "IUAmpTools/ConfigurationInfo.h"
+#include "IUAmpTools/Kinematics.h"
+
+#include "IUAmpTools/report.h"
+const char* IntensityEvaluator::kModule = "IntensityEvaluator";
+
+IntensityEvaluator::IntensityEvaluator( IntensityManager& intenManager,
+                                        unsigned int nParticles,
+                                        unsigned int maxEvents ) :
+m_ati( NULL ),
+m_intenManager( &intenManager ),
+m_maxEvents( maxEvents )
+{
+  
+  allocate( nParticles );
+}
+
+IntensityEvaluator::IntensityEvaluator( const ConfigurationInfo* cfgInfo,
+                                        const string& reactionName,
+                                        unsigned int maxEvents ) :
+// as in PlotGenerator the configuration info is not modified although
+// the AmpToolsInterface requires a non-const pointer
+m_ati( new AmpToolsInterface( const_cast< ConfigurationInfo* >( cfgInfo ),
+                              AmpToolsInterface::kMCGeneration ) ),
+m_intenManager( m_ati->intensityManager( reactionName ) ),
+m_maxEvents( maxEvents )
+{
+  
+  if( m_intenManager == NULL ){
+    
+    report( ERROR, kModule ) << "unknown reaction: " << reactionName << endl;
+    assert( false );
+  }
+  
+  allocate( cfgInfo->reaction( reactionName )->particleList().size() );
+}
+
+IntensityEvaluator::~IntensityEvaluator(){
+  
+  m_ampVecs.deallocAmpVecs();
+  if( m_ati != NULL ) delete m_ati;
+}
+
+void
+IntensityEvaluator::allocate( unsigned int nParticles ){
+  
+  assert( nParticles > 0 && m_maxEvents > 0 );
+  
+  // the arrays are owned by the AmpVecs
+  GDouble* pdData = new GDouble[4*nParticles*m_maxEvents];
+  GDouble* pdWeights = new GDouble[m_maxEvents];
+  
+  memset( pdData, 0, 4*nParticles*m_maxEvents*sizeof( GDouble ) );
+  for( unsigned int i = 0; i < m_maxEvents; ++i ) pdWeights[i] = 1;
+  
+  m_ampVecs.adoptData( pdData, pdWeights, m_maxEvents, nParticles );
+  
+  // the contents change with every calculation
+  m_ampVecs.m_cacheable = false;
+  
+  m_ampVecs.allocateTerms( *m_intenManager, true );
+}
+
+void
+IntensityEvaluator::prepareEvents( unsigned int nEvents ){
+  
+  // the four-vectors have been placed at the start of m_pdData -- set up
+  // the AmpVecs so that the calculations are done only for these events
+  // and the user data and amplitudes are recomputed, as loadEvent would
+  
+  m_ampVecs.m_iNTrueEvents = nEvents;
+  
+#ifdef GPU_ACCELERATION
+  
+  // the number of events on the GPU is fixed when the storage is
+  // allocated, so pad the remaining events with copies of the first
+  // rather than leaving four-vectors that may not be physical
+  
+  unsigned int nValues = 4*m_ampVecs.m_iNParticles;
+  for( unsigned long i = nEvents; i < m_ampVecs.m_iNEvents; ++i ){
+    
+    memcpy( m_ampVecs.m_pdData + nValues*i, m_ampVecs.m_pdData,
+            nValues*sizeof( GDouble ) );
+  }
+  
+  m_ampVecs.m_gpuMan.copyDataToGPU( m_ampVecs,
+                                    !m_intenManager->needsUserVarsOnly() );
+#else
+  
+  // the arrays are indexed by m_iNEvents, which is never larger
+  // than the number of events for which they were allocated
+  m_ampVecs.m_iNEvents = nEvents;
+  
+#endif
+  
+  m_ampVecs.m_termsValid = false;
+  m_ampVecs.m_integralValid = false;
+  m_ampVecs.m_userVarsOffset.clear();
+}
+
+void
+IntensityEvaluator::calcIntensities( const GDouble* fourVecs, unsigned int nEvents,
+                                     GDouble* intensities ){
+  
+  assert( nEvents > 0 && nEvents <= m_maxEvents );
+  
+  memcpy( m_ampVecs.m_pdData, fourVecs,
+          4*m_ampVecs.m_iNParticles*nEvents*sizeof( GDouble ) );
+  prepareEvents( nEvents );
+  
+  m_intenManager->calcIntensities( m_ampVecs );
+  
+  // undo the division by the number of events
+  double scale = 1;
+#ifndef USE_LEGACY_LN_LIK_SCALING
+  scale = nEvents;
+#endif
+  
+  for( unsigned int i = 0; i < nEvents; ++i ){
+    
+    intensities[i] = scale * m_ampVecs.m_pdIntensity[i];
+  }
+}
+
+double
+IntensityEvaluator::calcIntensity( const Kinematics* kinematics ){
+  
+  assert( kinematics->particleList().size() == m_ampVecs.m_iNParticles );
+  
+  for( unsigned int i = 0; i < m_ampVecs.m_iNParticles; ++i ){
+    
+    const TLorentzVector& p4 = kinematics->particle( i );
+    m_ampVecs.m_pdData[4*i+0] = p4.E();
+    m_ampVecs.m_pdData[4*i+1] = p4.Px();
+    m_ampVecs.m_pdData[4*i+2] = p4.Py();
+    m_ampVecs.m_pdData[4*i+3] = p4.Pz();
+  }
+  prepareEvents( 1 );
+  
+  m_intenManager->calcIntensities( m_ampVecs );
+  
+  return m_ampVecs.m_pdIntensity[0];
+}
+
+void
+IntensityEvaluator::calcAmplitudes( const GDouble* fourVecs, unsigned int nEvents ){
+  
+  assert( nEvents > 0 && nEvents <= m_maxEvents );
+  
+  memcpy( m_ampVecs.m_pdData, fourVecs,
+          4*m_ampVecs.m_iNParticles*nEvents*sizeof( GDouble ) );
+  prepareEvents( nEvents );
+  
+  m_intenManager->calcTerms( m_ampVecs );
+  
+#ifdef GPU_ACCELERATION
+  // the amplitudes are computed on the GPU
+  if( m_ampVecs.m_pdAmps == NULL ) m_ampVecs.allocateCPUAmpStorage( *m_intenManager );
+  m_ampVecs.m_gpuMan.copyAmpsFromGPU( m_ampVecs );
+#endif
+}
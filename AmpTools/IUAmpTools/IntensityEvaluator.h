@@ -0,0 +1,143 @@
+#if !(defined INTENSITYEVALUATOR)
+#define INTENSITYEVALUATOR
+
+//******************************************************************************
+// This file is part of AmpTools, a package for performing Amplitude Analysis
+// 
+// Copyright Trustees of Indiana University 2010, all rights reserved
+// 
+// This software written by Matthew Shepherd, Ryan Mitchell, and 
+//                  Hrayr Matevosyan at Indiana University, Bloomington
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice and author attribution, this list of conditions and the
+//    following disclaimer. 
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice and author attribution, this list of conditions and the
+//    following disclaimer in the documentation and/or other materials
+//    provided with the distribution.
+// 3. Neither the name of the University nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// 
+// Creation of derivative forms of this software for commercial
+// utilization may be subject to restriction; written permission may be
+// obtained from the Trustees of Indiana University.
+// 
+// INDIANA UNIVERSITY AND THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, 
+// EXPRESS OR IMPLIED.  By way of example, but not limitation, INDIANA 
+// UNIVERSITY MAKES NO REPRESENTATIONS OR WARRANTIES OF MERCANTABILITY OR 
+// FITNESS FOR ANY PARTICULAR PURPOSE OR THAT THE USE OF THIS SOFTWARE OR 
+// DOCUMENTATION WILL NOT INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS, 
+// OR OTHER RIGHTS.  Neither Indiana University nor the authors shall be 
+// held liable for any liability with respect to any claim by the user or 
+// any other party arising from use of the program.
+//******************************************************************************
+
+#include <string>
+#include <complex>
+
+#include "IUAmpTools/AmpVecs.h"
+#include "GPUManager/GPUCustomTypes.h"
+
+class IntensityManager;
+class AmpToolsInterface;
+class ConfigurationInfo;
+class Kinematics;
+
+using namespace std;
+
+/**
+ * This class evaluates intensities or amplitudes for one or a small
+ * batch of events at a time, as needed by applications that process
+ * events one by one, such as an event generator that calls AmpTools to
+ * weight each event.  Unlike IntensityManager::calcIntensity, which
+ * allocates and frees the storage for the amplitudes on every call,
+ * the storage is allocated once for a maximum number of events when
+ * the evaluator is constructed and reused for every call.
+ *
+ * The IntensityManager and its amplitudes keep track of the calculation
+ * in progress, so evaluators that are used concurrently in several
+ * threads must not share an IntensityManager.  The constructor that
+ * takes a ConfigurationInfo creates a private IntensityManager for the
+ * evaluator, so one such evaluator can be used in each thread.
+ *
+ * \ingroup IUAmpTools
+ */
+
+class IntensityEvaluator
+{
+  
+public:
+  
+  /**
+   * Construct an evaluator using an existing IntensityManager, which
+   * must not be used by another thread during the calculations.
+   */
+  IntensityEvaluator( IntensityManager& intenManager,
+                      unsigned int nParticles, unsigned int maxEvents = 1024 );
+  
+  /**
+   * Construct an evaluator with its own IntensityManager for a reaction
+   * in the ConfigurationInfo.  The amplitudes must be registered with the
+   * AmpToolsInterface beforehand, and the production parameters are the
+   * initial values in the ConfigurationInfo unless they are changed
+   * through intensityManager().
+   */
+  IntensityEvaluator( const ConfigurationInfo* cfgInfo, const string& reactionName,
+                      unsigned int maxEvents = 1024 );
+  
+  ~IntensityEvaluator();
+  
+  IntensityManager& intensityManager() { return *m_intenManager; }
+  
+  unsigned int maxEvents() const { return m_maxEvents; }
+  
+  /**
+   * Compute the intensities of nEvents events (at most maxEvents) whose
+   * four-vectors (E, px, py, pz for each particle) are stored in the
+   * layout of AmpVecs::m_pdData.
+   */
+  void calcIntensities( const GDouble* fourVecs, unsigned int nEvents,
+                        GDouble* intensities );
+  
+  /**
+   * Compute the intensity of one event.
+   */
+  double calcIntensity( const Kinematics* kinematics );
+  
+  /**
+   * Compute the amplitudes of nEvents events, which can be retrieved with
+   * the amplitude method below until the next calculation.  The terms are
+   * indexed in the order of IntensityManager::getTermNames.
+   */
+  void calcAmplitudes( const GDouble* fourVecs, unsigned int nEvents );
+  
+  complex< GDouble > amplitude( unsigned int iTerm, unsigned int iEvent ) const {
+    
+    const GDouble* amp = m_ampVecs.m_pdAmps + 2*m_ampVecs.m_iNEvents*iTerm + 2*iEvent;
+    return complex< GDouble >( amp[0], amp[1] );
+  }
+  
+private:
+  
+  // the evaluator owns storage so it should not be copied
+  IntensityEvaluator( const IntensityEvaluator& );
+  IntensityEvaluator& operator=( const IntensityEvaluator& );
+  
+  void allocate( unsigned int nParticles );
+  void prepareEvents( unsigned int nEvents );
+  
+  AmpToolsInterface* m_ati;
+  IntensityManager* m_intenManager;
+  
+  unsigned int m_maxEvents;
+  AmpVecs m_ampVecs;
+  
+  static const char* kModule;
+};
+
+#endif
@@ -62,7 +62,8 @@ m_reactionName( reactionName) ,
 m_needsUserVarsOnly( true ),
 m_optimizeParIteration( false ),
 m_flushFourVecsIfPossible( false ),
-m_forceUserVarRecalculation( false )
+m_forceUserVarRecalculation( false ),
+m_defaultTermIteration( 0 )
 {
 
 }
@@ -127,6 +128,14 @@ IntensityManager::termIndex( const string& termName ) const {
   return mapItr->second;
 }
 
+int
+IntensityManager::termIteration( int iTerm ) const {
+  
+  // without any knowledge of the parameters the term must be
+  // assumed to have changed since the last call
+  return ++m_defaultTermIteration;
+}
+
 bool
 IntensityManager::hasTerm(const string& name) const {
   
@@ -142,6 +142,21 @@ public:
    */
   virtual double calcIntensities( AmpVecs& ampVecs ) const = 0;
 
+  /**
+   * As above, but if updateTerms is false the terms already stored in
+   * ampVecs by a previous call are used without checking whether they
+   * need to be updated, which is useful when only the production factors
+   * have changed.  The default ignores updateTerms and calls the function
+   * above.
+   *
+   * \param[in,out] ampVecs a reference to the AmpVecs storage structure,
+   * four vectors will be read from this class and intensities written to it.
+   *
+   * \param[in] updateTerms false to reuse the terms stored in ampVecs
+   */
+  virtual double calcIntensities( AmpVecs& ampVecs, bool updateTerms ) const {
+    return calcIntensities( ampVecs ); }
+
   /**
    * This function calculates and returns the sum of the log of the intensities
    * stored in the AmpVecs structure. 
@@ -175,7 +190,8 @@ public:
    * This function calculates the intensity for one event using a Kinematics
    * object.  This is only useful for diagnostics on a small number of events.
    * The calcIntensities method should be used to calculate intensities
-   * for many events.
+   * for many events, and an IntensityEvaluator, which allocates its storage
+   * once, should be used to calculate intensities event by event.
    *
    * \param[in] kinematics a pointer to a Kinematics object
    */
@@ -216,6 +232,21 @@ public:
    */
   virtual bool hasTermWithFreeParam() const = 0;
   
+  /**
+   * This function returns a number that changes whenever a parameter
+   * of the term with index iTerm is updated.  It can be used to determine
+   * which terms have changed between two points in a fit without any
+   * access to data.  The number does not change for a term without
+   * free parameters.
+   *
+   * The default implementation, for managers that don't track their
+   * parameters, returns a different number on every call, so every
+   * term always counts as changed.
+   *
+   * \see updatePar
+   */
+  virtual int termIteration( int iTerm ) const;
+  
   /**
    * This function will return true if every amplitude factor can be
    * calculated from user-defined data variables.  In some instances
@@ -487,6 +518,9 @@ private:
   
   vector< AmpParameter > m_termScaleVec;
   
+  // advanced by the default termIteration on each call
+  mutable int m_defaultTermIteration;
+  
   static const char* kModule;
 };
 
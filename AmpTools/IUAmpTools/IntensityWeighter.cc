@@ -0,0 +1,211 @@
+//******************************************************************************
+// This file is part of AmpTools, a package for performing Amplitude Analysis
+// 
+// Copyright Trustees of Indiana University 2010, all rights reserved
+// 
+// This software written by Matthew Shepherd, Ryan Mitchell, and 
+//                  Hrayr Matevosyan at Indiana University, Bloomington
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice and author attribution, this list of conditions and the
+//    following disclaimer. 
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice and author attribution, this list of conditions and the
+//    following disclaimer in the documentation and/or other materials
+//    provided with the distribution.
+// 3. Neither the name of the University nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// 
+// Creation of derivative forms of this software for commercial
+// utilization may be subject to restriction; written permission may be
+// obtained from the Trustees of Indiana University.
+// 
+// INDIANA UNIVERSITY AND THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, 
+// EXPRESS OR IMPLIED.  By way of example, but not limitation, INDIANA 
+// UNIVERSITY MAKES NO REPRESENTATIONS OR WARRANTIES OF MERCANTABILITY OR 
+// FITNESS FOR ANY PARTICULAR PURPOSE OR THAT THE USE OF THIS SOFTWARE OR 
+// DOCUMENTATION WILL NOT INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS, 
+// OR OTHER RIGHTS.  Neither Indiana University nor the authors shall be 
+// held liable for any liability with respect to any claim by the user or 
+// any other party arising from use of the program.
+//******************************************************************************
+
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include <cassert>
+
+#include "IUAmpTools/IntensityWeighter.h"
+#include "IUAmpTools/FitResults.h"
+#include "IUAmpTools/ConfigurationInfo.h"
+#include "IUAmpTools/IntensityManager.h"
+#include "IUAmpTools/DataReader.h"
+#include "IUAmpTools/AmpVecs.h"
+
+#include "IUAmpTools/report.h"
+const char* IntensityWeighter::kModule = "IntensityWeighter";
+
+IntensityWeighter::IntensityWeighter( const FitResults& results,
+                                      const string& reactionName ) :
+// as in PlotGenerator the configuration info is not modified although
+// the AmpToolsInterface requires a non-const pointer
+m_ati( const_cast< ConfigurationInfo* >( results.configInfo() ),
+       AmpToolsInterface::kMCGeneration ),
+m_intenManager( m_ati.intensityManager( reactionName ) ),
+m_chunkSize( 100000 ),
+m_sumOfWeights( 0 )
+{
+  
+  if( m_intenManager == NULL ){
+    
+    report( ERROR, kModule ) << "unknown reaction: " << reactionName << endl;
+    assert( false );
+  }
+  
+  vector< AmplitudeInfo* > ampInfo =
+    results.configInfo()->amplitudeList( reactionName );
+  
+  for( unsigned int i = 0; i < ampInfo.size(); ++i ){
+    
+    m_ampNames.push_back( ampInfo[i]->fullName() );
+    m_fitProdAmps.push_back( results.productionParameter( m_ampNames[i] ) );
+  }
+  
+  // the vector is not resized after this point, so the
+  // IntensityManager can keep pointers to its elements
+  m_prodAmps = m_fitProdAmps;
+  
+  map< string, double > ampParameters = results.ampParMap();
+  
+  for( unsigned int i = 0; i < m_ampNames.size(); ++i ){
+    
+    m_intenManager->setExternalProductionFactor( m_ampNames[i], &(m_prodAmps[i]) );
+    
+    for( map< string, double >::const_iterator mapItr = ampParameters.begin();
+        mapItr != ampParameters.end();
+        ++mapItr ){
+      
+      m_intenManager->setParValue( m_ampNames[i], mapItr->first, mapItr->second );
+    }
+  }
+}
+
+void
+IntensityWeighter::setAmplitudes( const vector< string >& fullAmpNames ){
+  
+  for( unsigned int i = 0; i < m_ampNames.size(); ++i ){
+    
+    m_prodAmps[i] = complex< double >( 0, 0 );
+  }
+  
+  for( vector< string >::const_iterator name = fullAmpNames.begin();
+      name != fullAmpNames.end();
+      ++name ){
+    
+    vector< string >::const_iterator pos =
+      find( m_ampNames.begin(), m_ampNames.end(), *name );
+    
+    if( pos == m_ampNames.end() ){
+      
+      report( ERROR, kModule ) << "unknown amplitude: " << *name << endl;
+      assert( false );
+    }
+    
+    unsigned int i = pos - m_ampNames.begin();
+    m_prodAmps[i] = m_fitProdAmps[i];
+  }
+}
+
+void
+IntensityWeighter::setAllAmplitudes(){
+  
+  for( unsigned int i = 0; i < m_ampNames.size(); ++i ){
+    
+    m_prodAmps[i] = m_fitProdAmps[i];
+  }
+}
+
+unsigned long long
+IntensityWeighter::weightEvents( DataReader& reader, EventSink& sink ){
+  
+  assert( m_chunkSize > 0 );
+  
+  reader.resetSource();
+  
+  unsigned long long nWritten = 0;
+  m_sumOfWeights = 0;
+  
+  // the batch of events that is being written by the
+  // output thread while the next chunk is processed
+  vector< GDouble > writeBuffer;
+  vector< GDouble > writeWeights;
+  unsigned int nParticles = 0;
+  thread writer;
+  
+  // the output is only written while the next chunk is read if the
+  // reader can be used at the same time as another thread, e.g.,
+  // ROOT files are not safe to use from two threads by default
+  bool overlap = reader.isThreadSafe();
+  
+  while( true ){
+    
+    AmpVecs chunk;
+    unsigned long long nEvents = chunk.loadNextEvents( &reader, m_chunkSize );
+    if( nEvents == 0 ) break;
+    
+    chunk.allocateTerms( *m_intenManager, true );
+    m_intenManager->calcIntensities( chunk );
+    
+    // calcIntensities includes the weight of the event and divides
+    // by the number of events in the chunk unless the legacy scaling
+    // is used, which is undone so the scale of every chunk is the same
+    double scale = 1;
+#ifndef USE_LEGACY_LN_LIK_SCALING
+    scale = chunk.m_iNTrueEvents;
+#endif
+    
+    vector< GDouble > weights( nEvents );
+    for( unsigned long long iEvent = 0; iEvent < nEvents; ++iEvent ){
+      
+      weights[iEvent] = scale * chunk.m_pdIntensity[iEvent];
+      m_sumOfWeights += weights[iEvent];
+    }
+    
+    if( !overlap ){
+      
+      sink.writeEvents( chunk.m_pdData, &(weights[0]), nEvents,
+                        chunk.m_iNParticles );
+      
+      nWritten += nEvents;
+      continue;
+    }
+    
+    vector< GDouble > fourVecs( chunk.m_pdData,
+                                chunk.m_pdData + 4*chunk.m_iNParticles*nEvents );
+    
+    // hand the events to the output thread once it has
+    // finished with the previous batch
+    if( writer.joinable() ) writer.join();
+    writeBuffer.swap( fourVecs );
+    writeWeights.swap( weights );
+    nParticles = chunk.m_iNParticles;
+    
+    writer = thread( [&](){
+      sink.writeEvents( &(writeBuffer[0]), &(writeWeights[0]),
+                        writeWeights.size(), nParticles );
+    } );
+    
+    nWritten += nEvents;
+  }
+  
+  if( writer.joinable() ) writer.join();
+  
+  report( INFO, kModule ) << "Wrote " << nWritten << " events with a sum of "
+  << "weights of " << m_sumOfWeights << "." << endl;
+  
+  return nWritten;
+}
@@ -0,0 +1,112 @@
+#if !(defined INTENSITYWEIGHTER)
+#define INTENSITYWEIGHTER
+
+//******************************************************************************
+// This file is part of AmpTools, a package for performing Amplitude Analysis
+// 
+// Copyright Trustees of Indiana University 2010, all rights reserved
+// 
+// This software written by Matthew Shepherd, Ryan Mitchell, and 
+//                  Hrayr Matevosyan at Indiana University, Bloomington
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice and author attribution, this list of conditions and the
+//    following disclaimer. 
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice and author attribution, this list of conditions and the
+//    following disclaimer in the documentation and/or other materials
+//    provided with the distribution.
+// 3. Neither the name of the University nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// 
+// Creation of derivative forms of this software for commercial
+// utilization may be subject to restriction; written permission may be
+// obtained from the Trustees of Indiana University.
+// 
+// INDIANA UNIVERSITY AND THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, 
+// EXPRESS OR IMPLIED.  By way of example, but not limitation, INDIANA 
+// UNIVERSITY MAKES NO REPRESENTATIONS OR WARRANTIES OF MERCANTABILITY OR 
+// FITNESS FOR ANY PARTICULAR PURPOSE OR THAT THE USE OF THIS SOFTWARE OR 
+// DOCUMENTATION WILL NOT INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS, 
+// OR OTHER RIGHTS.  Neither Indiana University nor the authors shall be 
+// held liable for any liability with respect to any claim by the user or 
+// any other party arising from use of the program.
+//******************************************************************************
+
+#include <vector>
+#include <string>
+#include <complex>
+
+#include "IUAmpTools/AmpToolsInterface.h"
+#include "IUAmpTools/EventSink.h"
+
+class FitResults;
+class DataReader;
+class IntensityManager;
+
+using namespace std;
+
+/**
+ * This class weights events by the intensity of a fit, for example to
+ * reweight generated MC to the fit result, without holding the sample in
+ * memory.  The events are read from a DataReader in chunks of a fixed size,
+ * the intensities of each chunk are computed using the EventLoopThreads
+ * threads, and the events are passed with their new weights to an EventSink.
+ * If the DataReader reports that it is thread safe, the events are written
+ * on a separate thread while the next chunk is read and processed.
+ *
+ * The weight passed to the EventSink is the product of the weight of the
+ * event provided by the DataReader and the intensity.  The intensity may be
+ * restricted to a subset of the amplitudes, in which case the production
+ * parameters of all other amplitudes are set to zero, as in PlotGenerator.
+ *
+ * \ingroup IUAmpTools
+ */
+
+class IntensityWeighter
+{
+  
+public:
+  
+  IntensityWeighter( const FitResults& results, const string& reactionName );
+  
+  /**
+   * Restrict the intensity to the amplitudes with these full names
+   * (reaction::sum::amp).  By default all amplitudes of the reaction
+   * are used.
+   */
+  void setAmplitudes( const vector< string >& fullAmpNames );
+  void setAllAmplitudes();
+  
+  void setChunkSize( unsigned long long nEvents ) { m_chunkSize = nEvents; }
+  
+  /**
+   * Read all events from the reader and write them to the sink with
+   * their weights.  Returns the number of events written.
+   */
+  unsigned long long weightEvents( DataReader& reader, EventSink& sink );
+  
+  // the sum of the weights written by the last call to weightEvents
+  double sumOfWeights() const { return m_sumOfWeights; }
+  
+private:
+  
+  // the AmpToolsInterface is only used to build the IntensityManager
+  AmpToolsInterface m_ati;
+  IntensityManager* m_intenManager;
+  
+  vector< string > m_ampNames;
+  vector< complex< double > > m_fitProdAmps;
+  vector< complex< double > > m_prodAmps;
+  
+  unsigned long long m_chunkSize;
+  double m_sumOfWeights;
+  
+  static const char* kModule;
+};
+
+#endif
@@ -36,6 +36,7 @@
 
 #include <sys/time.h>
 #include <cassert>
+#include <cstring>
 #include <string>
 
 #include "IUAmpTools/LikelihoodCalculator.h"
@@ -44,6 +45,7 @@
 #include "IUAmpTools/Kinematics.h"
 #include "IUAmpTools/NormIntInterface.h"
 #include "IUAmpTools/ParameterManager.h"
+#include "IUAmpTools/CounterRandom.h"
 
 #include "MinuitInterface/MinuitMinimizationManager.h"
 #include "MinuitInterface/MinuitParameterManager.h"
@@ -67,6 +69,7 @@ m_normInt( normInt ),
 m_dataReaderSignal( dataReaderSignal ),
 m_dataReaderBkgnd( dataReaderBkgnd ),
 m_firstDataCalc( true ),
+m_dataLoaded( false ),
 m_firstNormIntCalc( true ),
 m_sumBkgWeights( 0 ),
 m_numBkgEvents( 0 ),
@@ -211,79 +214,93 @@ SCOREP_USER_REGION_BEGIN( normIntTerm, "normIntTerm", SCOREP_USER_REGION_TYPE_CO
 
 }
 
-double
-LikelihoodCalculator::dataTerm( bool suppressError ){
-#ifdef SCOREP
-SCOREP_USER_REGION_DEFINE( dataTerm )                                                                                    
-SCOREP_USER_REGION_BEGIN( dataTerm, "dataTerm", SCOREP_USER_REGION_TYPE_COMMON )
-#endif
-
-  if( m_firstDataCalc ) {
-    
-    // first calculation -- need to load the data
-    
-    report( DEBUG, kModule ) << "Allocating Data and Amplitude Array in LikelihoodCalculator for "
-      << m_intenManager.reactionName() << "..." << endl;
-    
-    m_ampVecsSignal.loadData( m_dataReaderSignal );
-    m_ampVecsSignal.allocateTerms( m_intenManager, true );
+void
+LikelihoodCalculator::loadData( bool suppressError ){
+  
+  if( m_dataLoaded ) return;
+  
+  report( DEBUG, kModule ) << "Allocating Data and Amplitude Array in LikelihoodCalculator for "
+    << m_intenManager.reactionName() << "..." << endl;
+  
+  m_ampVecsSignal.loadData( m_dataReaderSignal );
+  m_ampVecsSignal.allocateTerms( m_intenManager, true );
 
-    m_numDataEvents = m_ampVecsSignal.m_iNTrueEvents;
-    m_sumDataWeights = m_ampVecsSignal.m_dSumWeights;
+  m_numDataEvents = m_ampVecsSignal.m_iNTrueEvents;
+  m_sumDataWeights = m_ampVecsSignal.m_dSumWeights;
  
-    if( m_ampVecsSignal.m_hasNonUnityWeights && m_hasBackground ){
+  if( m_ampVecsSignal.m_hasNonUnityWeights && m_hasBackground ){
+  
+    report( WARNING, kModule ) << "\n"
+    << "****************************************************************\n"
+    << "* WARNING: Events in the signal data sample have weights       *\n"
+    << "*   that differ from 1 and a background data sample has been   *\n"
+    << "*   provided.  This will produce incorrect results.  The       *\n"
+    << "*   recommended solution is to set all signal weights to unity *\n"
+    << "*   and put all background events in the background file with  *\n"
+    << "*   weights such that the weighted sum mimics the background   *\n"
+    << "*   contribution to the likelihood.                            *\n"
+    << "****************************************************************\n" << endl;
+  }
+  
+  if( m_hasBackground ){
+        
+    m_ampVecsBkgnd.loadData( m_dataReaderBkgnd );
+    m_ampVecsBkgnd.allocateTerms( m_intenManager, true );
+
+    if( m_ampVecsBkgnd.m_hasMixedSignWeights ){
+      report( NOTICE, kModule ) << "\n"
+      << "***************************************************************\n"
+      << "* NOTICE:  Weights with both positive and negative signs were *\n"
+      << "* detected in the background file.  This may be desirable for *\n"
+      << "* some applications.  Older versions of AmpTools (v0.10.x and *\n"
+      << "* prior) will not properly handle this case and will also not *\n"
+      << "* print this notification to the screen.                      *\n"
+      << "***************************************************************\n" << endl;
+    }
     
-      report( WARNING, kModule ) << "\n"
+    m_sumBkgWeights = m_ampVecsBkgnd.m_dSumWeights;
+    
+    // the extra boolean allows MPI jobs to suppress this check which
+    // may fail on one of the follower nodes if the background sample
+    // is sparse
+    if( m_sumBkgWeights < 0 && !suppressError ){
+      report( ERROR, kModule ) << "\n"
       << "****************************************************************\n"
-      << "* WARNING: Events in the signal data sample have weights       *\n"
-      << "*   that differ from 1 and a background data sample has been   *\n"
-      << "*   provided.  This will produce incorrect results.  The       *\n"
-      << "*   recommended solution is to set all signal weights to unity *\n"
-      << "*   and put all background events in the background file with  *\n"
-      << "*   weights such that the weighted sum mimics the background   *\n"
-      << "*   contribution to the likelihood.                            *\n"
+      << "* ERROR: The sum of all background weights is negative.  This  *\n"
+      << "*   implies a negative background in the signal region, which  *\n"
+      << "*   unphysical.  The weighted sum of the background events     *\n"
+      << "*   should represent the background contribution to the signal *\n"
+      << "*   region.                                                    *\n"
       << "****************************************************************\n" << endl;
+      assert( false );
     }
     
-    if( m_hasBackground ){
-          
-      m_ampVecsBkgnd.loadData( m_dataReaderBkgnd );
-      m_ampVecsBkgnd.allocateTerms( m_intenManager, true );
-
-      if( m_ampVecsBkgnd.m_hasMixedSignWeights ){
-        report( NOTICE, kModule ) << "\n"
-        << "***************************************************************\n"
-        << "* NOTICE:  Weights with both positive and negative signs were *\n"
-        << "* detected in the background file.  This may be desirable for *\n"
-        << "* some applications.  Older versions of AmpTools (v0.10.x and *\n"
-        << "* prior) will not properly handle this case and will also not *\n"
-        << "* print this notification to the screen.                      *\n"
-        << "***************************************************************\n" << endl;
-      }
-      
-      m_sumBkgWeights = m_ampVecsBkgnd.m_dSumWeights;
-      
-      // the extra boolean allows MPI jobs to suppress this check which
-      // may fail on one of the follower nodes if the background sample
-      // is sparse
-      if( m_sumBkgWeights < 0 && !suppressError ){
-        report( ERROR, kModule ) << "\n"
-        << "****************************************************************\n"
-        << "* ERROR: The sum of all background weights is negative.  This  *\n"
-        << "*   implies a negative background in the signal region, which  *\n"
-        << "*   unphysical.  The weighted sum of the background events     *\n"
-        << "*   should represent the background contribution to the signal *\n"
-        << "*   region.                                                    *\n"
-        << "****************************************************************\n" << endl;
-        assert( false );
-      }
-      
-      m_numBkgEvents = m_ampVecsBkgnd.m_iNTrueEvents;
-    }
-    
-    report( DEBUG, kModule ) << "\tDone." << endl;
+    m_numBkgEvents = m_ampVecsBkgnd.m_iNTrueEvents;
   }
   
+  m_dataLoaded = true;
+  
+  report( DEBUG, kModule ) << "\tDone." << endl;
+}
+
+void
+LikelihoodCalculator::shareUserVars( const LikelihoodCalculator& source ){
+  
+  loadData();
+  
+  m_ampVecsSignal.shareUserVars( source.m_ampVecsSignal );
+  if( m_hasBackground ) m_ampVecsBkgnd.shareUserVars( source.m_ampVecsBkgnd );
+}
+
+double
+LikelihoodCalculator::dataTerm( bool suppressError ){
+#ifdef SCOREP
+SCOREP_USER_REGION_DEFINE( dataTerm )                                                                                    
+SCOREP_USER_REGION_BEGIN( dataTerm, "dataTerm", SCOREP_USER_REGION_TYPE_COMMON )
+#endif
+
+  if( m_firstDataCalc ) loadData( suppressError );
+  
   double sumLnI = m_intenManager.calcSumLogIntensity( m_ampVecsSignal );
   
   // if there is a background file, we try to correct the sumLnI for background
@@ -306,6 +323,73 @@ SCOREP_USER_REGION_END( dataTerm )
   return sumLnI;
 }
 
+void
+LikelihoodCalculator::resampleData( CounterRandom& random ){
+  
+#ifdef GPU_ACCELERATION
+  
+  // the sum of the log of the intensity is done on the GPU
+  // and doesn't use the multiplicities
+  report( ERROR, kModule ) << "Resampling of the data is not supported "
+  << "with GPU acceleration." << endl;
+  assert( false );
+#endif
+  
+  loadData();
+  
+  m_sumDataWeights = resample( m_ampVecsSignal, random );
+  if( m_hasBackground ) m_sumBkgWeights = resample( m_ampVecsBkgnd, random );
+}
+
+void
+LikelihoodCalculator::clearResampling(){
+  
+  if( m_ampVecsSignal.m_pdMultiplicity != NULL ){
+    
+    delete[] m_ampVecsSignal.m_pdMultiplicity;
+    m_ampVecsSignal.m_pdMultiplicity = NULL;
+  }
+  
+  if( m_ampVecsBkgnd.m_pdMultiplicity != NULL ){
+    
+    delete[] m_ampVecsBkgnd.m_pdMultiplicity;
+    m_ampVecsBkgnd.m_pdMultiplicity = NULL;
+  }
+  
+  if( m_dataLoaded ){
+    
+    m_sumDataWeights = m_ampVecsSignal.m_dSumWeights;
+    if( m_hasBackground ) m_sumBkgWeights = m_ampVecsBkgnd.m_dSumWeights;
+  }
+}
+
+double
+LikelihoodCalculator::resample( AmpVecs& a, CounterRandom& random ){
+  
+  unsigned long long nEvents = a.m_iNTrueEvents;
+  
+  if( a.m_pdMultiplicity == NULL ) a.m_pdMultiplicity = new GDouble[a.m_iNEvents];
+  
+  memset( a.m_pdMultiplicity, 0, a.m_iNEvents * sizeof( GDouble ) );
+  
+  for( unsigned long long i = 0; i < nEvents; ++i ){
+    
+    unsigned long long iEvent =
+      static_cast< unsigned long long >( random.uniform() * nEvents );
+    
+    a.m_pdMultiplicity[iEvent] += 1;
+  }
+  
+  // the sum of the weights of the resampled events
+  double sumWeights = 0;
+  for( unsigned long long iEvent = 0; iEvent < nEvents; ++iEvent ){
+    
+    sumWeights += a.m_pdMultiplicity[iEvent] * a.m_pdWeights[iEvent];
+  }
+  
+  return sumWeights;
+}
+
 void
 LikelihoodCalculator::invalidateTerms(){
   
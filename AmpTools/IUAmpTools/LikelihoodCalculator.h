@@ -49,6 +49,7 @@ class ParameterManager;
 class DataReader;
 class MinuitMinimizationManager;
 class MinuitParameter;
+class CounterRandom;
 
 /**
  * This class calculates -2 ln( likelihood ) for the fit.
@@ -88,6 +89,52 @@ public:
   
   void invalidateTerms();
   
+  /**
+   * This loads the signal and background data and allocates memory for
+   * the terms, which are computed in the first calculation of the
+   * likelihood.  It is called automatically on the first calculation of
+   * the likelihood, but it can be called earlier, e.g., to load all
+   * reactions while data sets are preloaded.  Subsequent calls do nothing.
+   *
+   * \param[in] suppressError do not abort if the sum of background
+   * weights is negative
+   */
+  void loadData( bool suppressError = false );
+  
+  /**
+   * This loads the data, if needed, and uses the user variables that
+   * another calculator for the same reaction and data has already computed
+   * rather than computing them again.  The source must remain allocated
+   * while this calculator is in use.
+   *
+   * \param[in] source a calculator that has computed the likelihood
+   *
+   * \see AmpVecs::shareUserVars
+   */
+  void shareUserVars( const LikelihoodCalculator& source );
+  
+  /**
+   * This resamples the signal data and the background with replacement,
+   * e.g., for a bootstrap estimate of the uncertainties.  Each event enters
+   * the data term with a multiplicity drawn from a multinomial distribution,
+   * so the number of events in each sample is unchanged, and the sums of
+   * the weights are recomputed with these multiplicities.  The data are
+   * not read again and the terms for the data are not recomputed.  The
+   * data are loaded first if needed.  This is not supported with GPU
+   * acceleration, nor with MPI, where the data are divided among the
+   * followers.
+   *
+   * \param[in] random the generator used to draw the events
+   *
+   * \see clearResampling
+   */
+  void resampleData( CounterRandom& random );
+  
+  /**
+   * This uses each event of the signal data and background once again.
+   */
+  void clearResampling();
+  
 protected:
   
   // helper functions -- also useful for pulling parts of the
@@ -111,6 +158,9 @@ protected:
   
 private:
   
+  // draws the multiplicities and returns the sum of the resampled weights
+  double resample( AmpVecs& a, CounterRandom& random );
+  
   bool m_hasBackground;
   
   const IntensityManager& m_intenManager;
@@ -121,6 +171,7 @@ private:
   
   bool m_firstNormIntCalc;
   bool m_firstDataCalc;
+  bool m_dataLoaded;
   
   double* m_prodFactorArray;
   const double* m_normIntArray;
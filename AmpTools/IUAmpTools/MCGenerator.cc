@@ -0,0 +1,221 @@
+//******************************************************************************
+// This file is part of AmpTools, a package for performing Amplitude Analysis
+// 
+// Copyright Trustees of Indiana University 2010, all rights reserved
+// 
+// This software written by Matthew Shepherd, Ryan Mitchell, and 
+//                  Hrayr Matevosyan at Indiana University, Bloomington
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice and author attribution, this list of conditions and the
+//    following disclaimer. 
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice and author attribution, this list of conditions and the
+//    following disclaimer in the documentation and/or other materials
+//    provided with the distribution.
+// 3. Neither the name of the University nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// 
+// Creation of derivative forms of this software for commercial
+// utilization may be subject to restriction; written permission may be
+// obtained from the Trustees of Indiana University.
+// 
+// INDIANA UNIVERSITY AND THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, 
+// EXPRESS OR IMPLIED.  By way of example, but not limitation, INDIANA 
+// UNIVERSITY MAKES NO REPRESENTATIONS OR WARRANTIES OF MERCANTABILITY OR 
+// FITNESS FOR ANY PARTICULAR PURPOSE OR THAT THE USE OF THIS SOFTWARE OR 
+// DOCUMENTATION WILL NOT INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS, 
+// OR OTHER RIGHTS.  Neither Indiana University nor the authors shall be 
+// held liable for any liability with respect to any claim by the user or 
+// any other party arising from use of the program.
+
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include <cassert>
+
+#include "IUAmpTools/MCGenerator.h"
+#include "IUAmpTools/IntensityManager.h"
+#include "IUAmpTools/AmpVecs.h"
+#include "IUAmpTools/EventLoopThreads.h"
+
+#include "IUAmpTools/report.h"
+const char* MCGenerator::kModule = "MCGenerator";
+
+MCGenerator::MCGenerator( const IntensityManager& intenManager,
+                          const PhaseSpace& phaseSpace,
+                          EventSink& sink, unsigned long long seed ) :
+m_intenManager( intenManager ),
+m_phaseSpace( phaseSpace ),
+m_sink( sink ),
+m_seed( seed ),
+m_chunkSize( 100000 ),
+m_numTrials( 0 ),
+m_numAccepted( 0 ),
+m_numViolations( 0 ),
+m_numRaised( 0 ),
+m_maxIntensity( 0 ),
+m_firstMaxIntensity( 0 ),
+m_safetyFactor( 1.2 ),
+m_policy( kRegenerate )
+{}
+
+unsigned long long
+MCGenerator::generate( unsigned long long nTrials, unsigned long long maxAccepted ){
+  
+  unsigned int nParticles = m_phaseSpace.numParticles();
+  assert( nParticles > 0 && m_chunkSize > 0 );
+  
+  unsigned long long nAccepted = 0;
+  unsigned long long nViolations = 0;
+  unsigned long long firstTrial = m_numTrials;
+  unsigned long long lastTrial = m_numTrials + nTrials;
+  
+  // the batch of accepted events that is being written by the
+  // output thread while the next chunk is processed
+  vector< GDouble > writeBuffer;
+  vector< GDouble > writeWeights;
+  thread writer;
+  
+  while( m_numTrials < lastTrial &&
+         ( maxAccepted == 0 || nAccepted < maxAccepted ) ){
+    
+    unsigned long long first = m_numTrials;
+    unsigned long long nEvents = min( m_chunkSize, lastTrial - first );
+    
+    // generate the phase space -- the arrays are owned by the AmpVecs below
+    GDouble* pdData = new GDouble[4*nParticles*nEvents];
+    GDouble* pdWeights = new GDouble[nEvents];
+    
+    EventLoopThreads::run( nEvents,
+      [&]( unsigned int iBlock, unsigned long firstEvent, unsigned long lastEvent ){
+        
+        for( unsigned long iEvent = firstEvent; iEvent < lastEvent; ++iEvent ){
+          
+          CounterRandom rng( m_seed, first + iEvent, 0 );
+          pdWeights[iEvent] =
+            m_phaseSpace.generate( rng, pdData + 4*nParticles*iEvent );
+        }
+      } );
+    
+    AmpVecs chunk;
+    chunk.adoptData( pdData, pdWeights, nEvents, nParticles );
+    chunk.allocateTerms( m_intenManager, true );
+    m_intenManager.calcIntensities( chunk );
+    
+    // the intensities include the phase space weight, and they are
+    // divided by the number of events in the chunk unless the legacy
+    // scaling is used, which is undone so the scale of every chunk
+    // is the same
+    double scale = 1;
+#ifndef USE_LEGACY_LN_LIK_SCALING
+    scale = chunk.m_iNTrueEvents;
+#endif
+    
+    double chunkMax = 0;
+    for( unsigned long long iEvent = 0; iEvent < nEvents; ++iEvent ){
+      
+      chunkMax = max( chunkMax, scale * chunk.m_pdIntensity[iEvent] );
+    }
+    
+    if( m_maxIntensity <= 0 ){
+      
+      m_maxIntensity = m_safetyFactor * chunkMax;
+      
+      report( INFO, kModule ) << "Using a maximum intensity of " << m_maxIntensity
+      << " for accept/reject." << endl;
+    }
+    if( m_firstMaxIntensity <= 0 ) m_firstMaxIntensity = m_maxIntensity;
+    
+    // for the kRegenerate policy the maximum is raised before the
+    // accept/reject of the chunk that exceeds it
+    if( m_policy == kRegenerate && chunkMax > m_maxIntensity ){
+      
+      m_maxIntensity = m_safetyFactor * chunkMax;
+      ++m_numRaised;
+      
+      report( INFO, kModule ) << "Intensity of " << chunkMax << " in the chunk "
+      << "starting at trial " << first << " exceeds the maximum -- raising the "
+      << "maximum to " << m_maxIntensity << " and redoing the chunk." << endl;
+    }
+    
+    // the accept/reject is cheap and done in order so that
+    // the output does not depend on the number of threads
+    vector< GDouble > accepted;
+    vector< GDouble > weights;
+    unsigned long long iEvent = 0;
+    for( ; iEvent < nEvents; ++iEvent ){
+      
+      double intensity = scale * chunk.m_pdIntensity[iEvent];
+      double weight = m_maxIntensity / m_firstMaxIntensity;
+      
+      if( intensity > m_maxIntensity ){
+        
+        ++nViolations;
+        if( m_policy == kReweight ) weight *= intensity / m_maxIntensity;
+      }
+      
+      CounterRandom rng( m_seed, first + iEvent, 1 );
+      if( rng.uniform() * m_maxIntensity >= intensity ) continue;
+      
+      accepted.insert( accepted.end(), chunk.m_pdData + 4*nParticles*iEvent,
+                       chunk.m_pdData + 4*nParticles*( iEvent + 1 ) );
+      weights.push_back( m_policy == kReweight ? weight : 1 );
+      
+      if( ++nAccepted == maxAccepted ){
+        
+        ++iEvent;
+        break;
+      }
+    }
+    m_numTrials += iEvent;
+    
+    // the kReweight policy keeps the events of this chunk but
+    // uses a larger maximum for the following chunks
+    if( m_policy == kReweight && chunkMax > m_maxIntensity ){
+      
+      m_maxIntensity = m_safetyFactor * chunkMax;
+      ++m_numRaised;
+    }
+    
+    // hand the accepted events to the output thread once it has
+    // finished with the previous batch
+    if( writer.joinable() ) writer.join();
+    writeBuffer.swap( accepted );
+    writeWeights.swap( weights );
+    
+    if( !writeWeights.empty() ){
+      
+      writer = thread( [&](){
+        m_sink.writeEvents( &(writeBuffer[0]), &(writeWeights[0]),
+                            writeWeights.size(), nParticles );
+      } );
+    }
+  }
+  
+  if( writer.joinable() ) writer.join();
+  
+  m_numAccepted += nAccepted;
+  m_numViolations += nViolations;
+  
+  report( INFO, kModule ) << "Accepted " << nAccepted << " of "
+  << m_numTrials - firstTrial << " trials." << endl;
+  
+  if( nViolations > 0 && m_policy == kWarn ){
+    
+    report( WARNING, kModule ) << nViolations << " events exceeded the maximum "
+    << "intensity -- the generated distribution is biased, increase the safety "
+    << "factor or set the maximum intensity." << endl;
+  }
+  else if( nViolations > 0 && m_policy == kReweight ){
+    
+    report( NOTICE, kModule ) << nViolations << " events exceeded the maximum "
+    << "intensity and were given weights greater than one." << endl;
+  }
+  
+  return nAccepted;
+}
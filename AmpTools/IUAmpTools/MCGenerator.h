@@ -0,0 +1,166 @@
+#if !(defined MCGENERATOR)
+#define MCGENERATOR
+
+//******************************************************************************
+// This file is part of AmpTools, a package for performing Amplitude Analysis
+// 
+// Copyright Trustees of Indiana University 2010, all rights reserved
+// 
+// This software written by Matthew Shepherd, Ryan Mitchell, and 
+//                  Hrayr Matevosyan at Indiana University, Bloomington
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice and author attribution, this list of conditions and the
+//    following disclaimer. 
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice and author attribution, this list of conditions and the
+//    following disclaimer in the documentation and/or other materials
+//    provided with the distribution.
+// 3. Neither the name of the University nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// 
+// Creation of derivative forms of this software for commercial
+// utilization may be subject to restriction; written permission may be
+// obtained from the Trustees of Indiana University.
+// 
+// INDIANA UNIVERSITY AND THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, 
+// EXPRESS OR IMPLIED.  By way of example, but not limitation, INDIANA 
+// UNIVERSITY MAKES NO REPRESENTATIONS OR WARRANTIES OF MERCANTABILITY OR 
+// FITNESS FOR ANY PARTICULAR PURPOSE OR THAT THE USE OF THIS SOFTWARE OR 
+// DOCUMENTATION WILL NOT INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS, 
+// OR OTHER RIGHTS.  Neither Indiana University nor the authors shall be 
+// held liable for any liability with respect to any claim by the user or 
+// any other party arising from use of the program.
+
+#include "IUAmpTools/CounterRandom.h"
+#include "IUAmpTools/EventSink.h"
+#include "GPUManager/GPUCustomTypes.h"
+
+class IntensityManager;
+
+using namespace std;
+
+/**
+ * This class generates events distributed according to the intensity
+ * of an IntensityManager by accept/reject on events provided by a
+ * user-defined phase space generator.  The events are processed in
+ * chunks of a fixed size so the memory used does not depend on the
+ * number of events:  for each chunk the phase space events are generated
+ * and the intensities computed using the EventLoopThreads threads, the
+ * accept/reject is done, and the accepted events are handed to the
+ * user-defined EventSink on a separate thread while the next chunk is
+ * generated.  The weights of the events passed to the EventSink are one
+ * unless the kReweight policy below is used.
+ *
+ * Every event has its own CounterRandom streams, one for the phase space
+ * and one for the accept/reject decision, and the accepted events are
+ * written in order, so the output depends only on the seed and the chunk
+ * size and not on the number of threads.
+ *
+ * The maximum intensity used for the accept/reject is the largest value
+ * in the first chunk times a safety factor unless it is set explicitly,
+ * and it is raised as the chunks are processed if events exceed it.
+ * How such an envelope violation is treated is set by the ViolationPolicy:
+ *   - kRegenerate (default):  events above the maximum are not clipped.
+ *     The maximum is raised to the largest value in the chunk times the
+ *     safety factor and the accept/reject for the whole chunk is redone
+ *     with the raised maximum, which is then used for later chunks.
+ *   - kReweight:  events above the maximum are accepted with a weight equal
+ *     to the ratio of the intensity to the maximum, and the maximum is raised
+ *     for later chunks, whose events then carry the weight of the ratio of the
+ *     new maximum to the first.  The sample is unbiased if the weights
+ *     are used.
+ *   - kWarn:  the maximum is not changed and a warning is printed with the
+ *     number of events that exceeded it; the sample is biased.
+ *
+ * For a peaked intensity the efficiency of the accept/reject can be
+ * improved by generating the phase space from a proposal distribution
+ * that follows the peaks, as described for PhaseSpace::generate below.
+ *
+ * \ingroup IUAmpTools
+ */
+
+class MCGenerator
+{
+  
+public:
+  
+  /**
+   * The user provides the phase space by deriving from this class.
+   * The generate method is called concurrently from several threads
+   * and must not modify shared state.
+   */
+  class PhaseSpace
+  {
+  public:
+    
+    virtual ~PhaseSpace() {}
+    
+    virtual unsigned int numParticles() const = 0;
+    
+    /**
+     * Fill E, px, py, pz for each particle of one event using only the
+     * random numbers from rng, and return the weight of the event.  The
+     * intensity is multiplied by the weight in the accept/reject.  For
+     * uniform phase space the weight is one.  To sample from an importance
+     * sampling proposal, return the ratio of the phase space density to the
+     * density of the proposal at the generated point -- any constant
+     * normalization of this ratio is absorbed in the maximum intensity.
+     */
+    virtual double generate( CounterRandom& rng, GDouble* fourVecs ) const = 0;
+  };
+  
+  enum ViolationPolicy { kRegenerate = 0, kReweight, kWarn };
+  
+  MCGenerator( const IntensityManager& intenManager, const PhaseSpace& phaseSpace,
+               EventSink& sink, unsigned long long seed );
+  
+  void setChunkSize( unsigned long long nEvents ) { m_chunkSize = nEvents; }
+  void setMaxIntensity( double maxIntensity ) { m_maxIntensity = maxIntensity; }
+  void setSafetyFactor( double factor ) { m_safetyFactor = factor; }
+  void setViolationPolicy( ViolationPolicy policy ) { m_policy = policy; }
+  
+  /**
+   * Generate nTrials phase space events and write those that are accepted,
+   * stopping early if maxAccepted events (if non-zero) have been accepted.
+   * Returns the number of accepted events.  Subsequent calls continue
+   * with new events.
+   */
+  unsigned long long generate( unsigned long long nTrials,
+                               unsigned long long maxAccepted = 0 );
+  
+  unsigned long long numTrials() const { return m_numTrials; }
+  unsigned long long numAccepted() const { return m_numAccepted; }
+  double maxIntensity() const { return m_maxIntensity; }
+  
+  // the number of events above the maximum intensity used in their
+  // accept/reject (always zero for kRegenerate) and the number of
+  // chunks for which the maximum was raised
+  unsigned long long numViolations() const { return m_numViolations; }
+  unsigned long long numRaised() const { return m_numRaised; }
+  
+private:
+  
+  const IntensityManager& m_intenManager;
+  const PhaseSpace& m_phaseSpace;
+  EventSink& m_sink;
+  
+  unsigned long long m_seed;
+  unsigned long long m_chunkSize;
+  unsigned long long m_numTrials;
+  unsigned long long m_numAccepted;
+  unsigned long long m_numViolations;
+  unsigned long long m_numRaised;
+  double m_maxIntensity;
+  double m_firstMaxIntensity;
+  double m_safetyFactor;
+  ViolationPolicy m_policy;
+  
+  static const char* kModule;
+};
+
+#endif
@@ -0,0 +1,141 @@
+//******************************************************************************
+// This file is part of AmpTools, a package for performing Amplitude Analysis
+// 
+// Copyright Trustees of Indiana University 2010, all rights reserved
+// 
+// This software written by Matthew Shepherd, Ryan Mitchell, and 
+//                  Hrayr Matevosyan at Indiana University, Bloomington
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice and author attribution, this list of conditions and the
+//    following disclaimer. 
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice and author attribution, this list of conditions and the
+//    following disclaimer in the documentation and/or other materials
+//    provided with the distribution.
+// 3. Neither the name of the University nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// 
+// Creation of derivative forms of this software for commercial
+// utilization may be subject to restriction; written permission may be
+// obtained from the Trustees of Indiana University.
+// 
+// INDIANA UNIVERSITY AND THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, 
+// EXPRESS OR IMPLIED.  By way of example, but not limitation, INDIANA 
+// UNIVERSITY MAKES NO REPRESENTATIONS OR WARRANTIES OF MERCANTABILITY OR 
+// FITNESS FOR ANY PARTICULAR PURPOSE OR THAT THE USE OF THIS SOFTWARE OR 
+// DOCUMENTATION WILL NOT INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS, 
+// OR OTHER RIGHTS.  Neither Indiana University nor the authors shall be 
+// held liable for any liability with respect to any claim by the user or 
+// any other party arising from use of the program.
+//******************************************************************************
+
+#include <vector>
+#include <cstdlib>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "IUAmpTools/MappedFile.h"
+
+#include "IUAmpTools/report.h"
+const char* MappedFile::kModule = "MappedFile";
+
+MappedFile::MappedFile( const string& fileName ) :
+m_data( NULL ),
+m_size( 0 )
+{
+  int fd = open( fileName.c_str(), O_RDONLY );
+  if( fd < 0 ) return;
+  
+  struct stat fileStat;
+  if( fstat( fd, &fileStat ) != 0 || fileStat.st_size == 0 ){
+    
+    close( fd );
+    return;
+  }
+  
+  void* addr = mmap( NULL, fileStat.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+  
+  // the mapping remains valid after the file is closed
+  close( fd );
+  
+  if( addr == MAP_FAILED ){
+    
+    report( WARNING, kModule ) << "Unable to map file " << fileName << endl;
+    return;
+  }
+  
+  m_data = static_cast< char* >( addr );
+  m_size = fileStat.st_size;
+}
+
+MappedFile::MappedFile( const string& directory, unsigned long long size ) :
+m_data( NULL ),
+m_size( 0 )
+{
+  string nameTemplate = directory + "/amptools_scratch_XXXXXX";
+  vector< char > fileName( nameTemplate.begin(), nameTemplate.end() );
+  fileName.push_back( '\0' );
+  
+  int fd = mkstemp( &(fileName[0]) );
+  
+  if( fd < 0 ){
+    
+    report( WARNING, kModule ) << "Unable to create scratch file in " << directory << endl;
+    return;
+  }
+  
+  // the file disappears from the directory now and the space
+  // is freed once the mapping is released
+  unlink( &(fileName[0]) );
+  
+  // the blocks are reserved now rather than when the pages are first
+  // written -- a sparse file would lead to a SIGBUS on access if the
+  // file system fills, while a failure here lets the caller fall back
+  // to ordinary memory
+  if( size == 0 || !reserveBlocks( fd, size ) ){
+    
+    close( fd );
+    return;
+  }
+  
+  void* addr = mmap( NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+  close( fd );
+  
+  if( addr == MAP_FAILED ){
+    
+    report( WARNING, kModule ) << "Unable to map scratch file in " << directory << endl;
+    return;
+  }
+  
+  madvise( addr, size, MADV_SEQUENTIAL );
+  
+  m_data = static_cast< char* >( addr );
+  m_size = size;
+}
+
+bool
+MappedFile::reserveBlocks( int fd, unsigned long long size ){
+  
+#if defined(__APPLE__)
+  // there is no posix_fallocate on MacOS
+  fstore_t store = { F_ALLOCATEALL, F_PEOFPOSMODE, 0, (off_t)size, 0 };
+  if( fcntl( fd, F_PREALLOCATE, &store ) == -1 ) return false;
+  return ftruncate( fd, size ) == 0;
+#else
+  return posix_fallocate( fd, 0, size ) == 0;
+#endif
+}
+
+MappedFile::~MappedFile(){
+  
+  if( m_data != NULL )
+    munmap( m_data, m_size );
+}
@@ -0,0 +1,117 @@
+#if !defined(MAPPEDFILE)
+#define MAPPEDFILE
+
+//******************************************************************************
+// This file is part of AmpTools, a package for performing Amplitude Analysis
+// 
+// Copyright Trustees of Indiana University 2010, all rights reserved
+// 
+// This software written by Matthew Shepherd, Ryan Mitchell, and 
+//                  Hrayr Matevosyan at Indiana University, Bloomington
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice and author attribution, this list of conditions and the
+//    following disclaimer. 
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice and author attribution, this list of conditions and the
+//    following disclaimer in the documentation and/or other materials
+//    provided with the distribution.
+// 3. Neither the name of the University nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// 
+// Creation of derivative forms of this software for commercial
+// utilization may be subject to restriction; written permission may be
+// obtained from the Trustees of Indiana University.
+// 
+// INDIANA UNIVERSITY AND THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, 
+// EXPRESS OR IMPLIED.  By way of example, but not limitation, INDIANA 
+// UNIVERSITY MAKES NO REPRESENTATIONS OR WARRANTIES OF MERCANTABILITY OR 
+// FITNESS FOR ANY PARTICULAR PURPOSE OR THAT THE USE OF THIS SOFTWARE OR 
+// DOCUMENTATION WILL NOT INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS, 
+// OR OTHER RIGHTS.  Neither Indiana University nor the authors shall be 
+// held liable for any liability with respect to any claim by the user or 
+// any other party arising from use of the program.
+//******************************************************************************
+
+#include <string>
+
+using namespace std;
+
+/**
+ * This class provides read-only access to the contents of a file through
+ * a memory map.  The pages of the file are loaded by the operating system
+ * as they are accessed and may be shared by all processes on a node that
+ * map the same file.  The mapping is released when the object is destroyed.
+ *
+ * It can also provide a writable block of scratch memory that is backed
+ * by an unnamed file rather than by swap, so that the block can be larger
+ * than the physical memory of the machine.
+ *
+ * \ingroup IUAmpTools
+ */
+
+class MappedFile
+{
+  
+public:
+  
+  /**
+   * The constructor maps the file.  If the file cannot be opened or
+   * mapped then isValid() will return false.
+   *
+   * \param[in] fileName the name of the file to map
+   */
+  MappedFile( const string& fileName );
+  
+  /**
+   * This constructor creates a temporary file of the requested size in
+   * the directory and maps it for reading and writing.  The file is
+   * removed from the directory immediately, so the space is returned to
+   * the file system when the object is destroyed or the program exits.
+   * The disk space for the whole block is reserved up front.  The
+   * operating system is advised that the memory will be accessed
+   * sequentially.  If the file cannot be created or the space cannot
+   * be reserved then isValid() will return false.
+   *
+   * \param[in] directory the directory for the temporary file
+   * \param[in] size the size of the block in bytes
+   */
+  MappedFile( const string& directory, unsigned long long size );
+  
+  ~MappedFile();
+  
+  bool isValid() const { return m_data != NULL; }
+  
+  /**
+   * A pointer to the beginning of the file contents, which is
+   * aligned to a page boundary.
+   */
+  const char* data() const { return m_data; }
+  char* data() { return m_data; }
+  
+  /**
+   * The size of the file in bytes.
+   */
+  unsigned long long size() const { return m_size; }
+  
+private:
+  
+  // the mapping is owned by the object and can't be copied
+  MappedFile( const MappedFile& );
+  MappedFile& operator=( const MappedFile& );
+  
+  // allocate the blocks of a file so that writing to the mapping
+  // can't fail later for lack of space
+  static bool reserveBlocks( int fd, unsigned long long size );
+  
+  char* m_data;
+  unsigned long long m_size;
+  
+  static const char* kModule;
+};
+
+#endif
@@ -0,0 +1,378 @@
+//******************************************************************************
+// This file is part of AmpTools, a package for performing Amplitude Analysis
+// 
+// Copyright Trustees of Indiana University 2010, all rights reserved
+// 
+// This software written by Matthew Shepherd, Ryan Mitchell, and 
+//                  Hrayr Matevosyan at Indiana University, Bloomington
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice and author attribution, this list of conditions and the
+//    following disclaimer. 
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice and author attribution, this list of conditions and the
+//    following disclaimer in the documentation and/or other materials
+//    provided with the distribution.
+// 3. Neither the name of the University nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// 
+// Creation of derivative forms of this software for commercial
+// utilization may be subject to restriction; written permission may be
+// obtained from the Trustees of Indiana University.
+// 
+// INDIANA UNIVERSITY AND THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, 
+// EXPRESS OR IMPLIED.  By way of example, but not limitation, INDIANA 
+// UNIVERSITY MAKES NO REPRESENTATIONS OR WARRANTIES OF MERCANTABILITY OR 
+// FITNESS FOR ANY PARTICULAR PURPOSE OR THAT THE USE OF THIS SOFTWARE OR 
+// DOCUMENTATION WILL NOT INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS, 
+// OR OTHER RIGHTS.  Neither Indiana University nor the authors shall be 
+// held liable for any liability with respect to any claim by the user or 
+// any other party arising from use of the program.
+//******************************************************************************
+
+#include <vector>
+#include <set>
+#include <string>
+#include <sstream>
+#include <thread>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cassert>
+
+#include "IUAmpTools/MultiStartFit.h"
+#include "IUAmpTools/AmpToolsInterface.h"
+#include "IUAmpTools/AmplitudeManager.h"
+#include "IUAmpTools/ConfigurationInfo.h"
+#include "IUAmpTools/NormIntInterface.h"
+#include "IUAmpTools/LikelihoodCalculator.h"
+#include "IUAmpTools/EventLoopThreads.h"
+#include "IUAmpTools/FitResults.h"
+#include "IUAmpTools/DataReader.h"
+#include "IUAmpTools/AmpVecs.h"
+#include "MinuitInterface/MinuitMinimizationManager.h"
+
+#include "IUAmpTools/report.h"
+const char* MultiStartFit::kModule = "MultiStartFit";
+
+MultiStartFit::MultiStartFit( ConfigurationInfo* cfgInfo ) :
+m_cfgInfo( cfgInfo ),
+m_numStarts( 1 ),
+m_numConcurrent( 0 ),
+m_seed( 0 ),
+m_maxFitFraction( 1 ),
+m_strategy( 1 ),
+m_runHesse( false ),
+m_bootstrap( false ),
+m_randomizeStarts( true ),
+m_bestStart( -1 )
+{}
+
+MultiStartFit::~MultiStartFit(){
+  
+  clearResults();
+}
+
+void
+MultiStartFit::randomizeParameter( const string& parName, float min, float max ){
+  
+  m_randomPars.push_back( make_pair( parName, make_pair( min, max ) ) );
+}
+
+void
+MultiStartFit::setBootstrap( bool bootstrap ){
+  
+  m_bootstrap = bootstrap;
+  m_randomizeStarts = !bootstrap;
+}
+
+const FitResults*
+MultiStartFit::fitResults( unsigned int iStart ) const {
+  
+  assert( iStart < m_results.size() );
+  return m_results[iStart];
+}
+
+bool
+MultiStartFit::converged( unsigned int iStart ) const {
+  
+  const FitResults* results = fitResults( iStart );
+  
+  return ( results->lastMinuitCommandStatus() == 0 &&
+           results->eMatrixStatus() == 3 );
+}
+
+const FitResults*
+MultiStartFit::bestFit() const {
+  
+  return ( m_bestStart < 0 ? NULL : m_results[m_bestStart] );
+}
+
+unsigned int
+MultiStartFit::fit( const string& fileName ){
+  
+  clearResults();
+  
+  if( m_numStarts == 0 ) return 0;
+  
+  unsigned int nFits = m_numConcurrent;
+  if( nFits == 0 ){
+    
+    nFits = thread::hardware_concurrency() / EventLoopThreads::numThreads();
+  }
+  if( nFits == 0 ) nFits = 1;
+  if( nFits > m_numStarts ) nFits = m_numStarts;
+  
+  vector< ReactionInfo* > reactions = m_cfgInfo->reactionList();
+  
+  // these static settings are changed while the fits are set up
+  // and restored afterwards
+  
+  unsigned int preloadThreads = AmpToolsInterface::preloadThreads();
+  unsigned long long genMCChunkSize = NormIntInterface::genMCChunkSize();
+  string cacheDirectory = AmplitudeManager::cacheDirectory();
+  
+  // ************************
+  // read each data set once
+  // ************************
+  
+  // this interface is only used to create the data readers -- the
+  // user data readers return the same instance for the same arguments,
+  // so the fits below use these readers while this interface exists
+  AmpToolsInterface* loader =
+    new AmpToolsInterface( m_cfgInfo, AmpToolsInterface::kPlotGeneration );
+  
+  set< DataReader* > readers;
+  for( unsigned int i = 0; i < reactions.size(); ++i ){
+    
+    string reactionName = reactions[i]->reactionName();
+    readers.insert( loader->dataReader( reactionName ) );
+    readers.insert( loader->bkgndReader( reactionName ) );
+    readers.insert( loader->genMCReader( reactionName ) );
+    readers.insert( loader->accMCReader( reactionName ) );
+  }
+  
+  // as in AmpToolsInterface the data sets are only read concurrently
+  // if requested, since the readers must support it
+  AmpVecs::preloadData( readers, preloadThreads > 0 ? preloadThreads : 1 );
+  
+  // ************************
+  // set up one interface for each concurrent fit
+  // ************************
+  
+  // this is done serially:  the bookkeeping of shared data sets is not
+  // thread safe, so all data are loaded, the user variables computed,
+  // and the generated MC attached before the fits start
+  
+  // the generated MC is held in memory, rather than read in pieces,
+  // so it is read once and shared like the other samples
+  NormIntInterface::setGenMCChunkSize( 0 );
+  AmpToolsInterface::setPreloadThreads( 0 );
+  
+  vector< AmpToolsInterface* > atis;
+  for( unsigned int k = 0; k < nFits; ++k ){
+    
+    report( INFO, kModule ) << "Setting up fit " << k + 1 << " of "
+    << nFits << " concurrent fits..." << endl;
+    
+    AmpToolsInterface* ati = new AmpToolsInterface( m_cfgInfo );
+    
+    // the four-vectors are shared, so they must not be freed
+    // by one of the fits
+    for( unsigned int i = 0; i < reactions.size(); ++i ){
+      
+      IntensityManager* intenMan =
+        ati->intensityManager( reactions[i]->reactionName() );
+      if( intenMan != NULL ) intenMan->setFlushFourVecsIfPossible( false );
+    }
+    
+    // the user variables computed by the first fit are used by all
+    // of the others -- they are only read during the fits
+    if( k > 0 ){
+      
+      for( unsigned int i = 0; i < reactions.size(); ++i ){
+        
+        string reactionName = reactions[i]->reactionName();
+        
+        LikelihoodCalculator* likCalc = ati->likelihoodCalculator( reactionName );
+        if( likCalc != NULL ){
+          
+          likCalc->shareUserVars( *atis[0]->likelihoodCalculator( reactionName ) );
+        }
+        
+        NormIntInterface* normInt = ati->normIntInterface( reactionName );
+        if( normInt != NULL && normInt->hasAccessToMC() ){
+          
+          normInt->shareUserVars( *atis[0]->normIntInterface( reactionName ) );
+        }
+      }
+    }
+    
+    ati->likelihood();
+    
+    for( unsigned int i = 0; i < reactions.size(); ++i ){
+      
+      NormIntInterface* normInt =
+        ati->normIntInterface( reactions[i]->reactionName() );
+      if( normInt != NULL && normInt->hasAccessToMC() ) normInt->forceCacheUpdate();
+    }
+    
+    atis.push_back( ati );
+  }
+  
+  AmpVecs::releasePreloadedData();
+  delete loader;
+  
+  // nothing is read from or written to the cache while the fits run
+  AmplitudeManager::setCacheDirectory( "" );
+  
+  NormIntInterface::setGenMCChunkSize( genMCChunkSize );
+  AmpToolsInterface::setPreloadThreads( preloadThreads );
+  
+  // ************************
+  // run the fits
+  // ************************
+  
+  // each fit writes its results to its own file since the
+  // results held by the interface are replaced by the next start
+  vector< string > startFiles;
+  for( unsigned int i = 0; i < m_numStarts; ++i ){
+    
+    ostringstream startFile;
+    startFile << fileName << ".start" << i;
+    startFiles.push_back( startFile.str() );
+  }
+  
+  report( INFO, kModule ) << "Performing " << m_numStarts << " fits with "
+  << nFits << " concurrent fits..." << endl;
+  
+  atomic< unsigned int > next( 0 );
+  
+  auto worker = [&]( AmpToolsInterface* ati ){
+    
+    for( unsigned int i = next++; i < m_numStarts; i = next++ ){
+      
+      // the replicas of a bootstrap can keep the terms that
+      // don't depend on free parameters from one start to the next
+      ati->reinitializePars( m_bootstrap );
+      
+      if( m_randomizeStarts ){
+        
+        ati->setRandomStream( m_seed, i );
+        ati->randomizeProductionPars( m_maxFitFraction );
+        
+        for( vector< pair< string, pair< float, float > > >::const_iterator
+             par = m_randomPars.begin(); par != m_randomPars.end(); ++par ){
+          
+          ati->randomizeParameter( par->first, par->second.first, par->second.second );
+        }
+      }
+      
+      if( m_bootstrap ) ati->setBootstrapReplica( m_seed, i );
+      
+      MinuitMinimizationManager* fitManager = ati->minuitMinimizationManager();
+      fitManager->setStrategy( m_strategy );
+      
+      fitManager->migradMinimization();
+      if( m_runHesse ) fitManager->hesseEvaluation();
+      
+      // the interface owns the results but only provides const access
+      FitResults* results = const_cast< FitResults* >( ati->fitResults() );
+      results->saveResults();
+      results->writeBinaryResults( startFiles[i] );
+      
+      report( INFO, kModule ) << "Fit " << i << ":  -2 ln(L) = "
+      << results->likelihood() << ", status = " << fitManager->status()
+      << ", error matrix status = " << fitManager->eMatrixStatus() << endl;
+    }
+  };
+  
+  vector< thread > threads;
+  for( unsigned int k = 1; k < nFits; ++k ){
+    
+    threads.push_back( thread( worker, atis[k] ) );
+  }
+  
+  worker( atis[0] );
+  
+  for( vector< thread >::iterator thr = threads.begin();
+       thr != threads.end(); ++thr ){
+    
+    thr->join();
+  }
+  
+  // the first fit owns the shared user variables
+  for( unsigned int k = nFits; k > 0; --k ){
+    
+    delete atis[k-1];
+  }
+  
+  AmplitudeManager::setCacheDirectory( cacheDirectory );
+  
+  // ************************
+  // collect the results
+  // ************************
+  
+  vector< const FitResults* > startResults;
+  for( unsigned int i = 0; i < m_numStarts; ++i ){
+    
+    startResults.push_back( new FitResults( startFiles[i], 0, true ) );
+  }
+  
+  FitResults::writeBinaryResults( fileName, startResults );
+  
+  for( unsigned int i = 0; i < m_numStarts; ++i ){
+    
+    delete startResults[i];
+    remove( startFiles[i].c_str() );
+    
+    m_results.push_back( new FitResults( fileName, i, true ) );
+  }
+  
+  unsigned int nConverged = 0;
+  for( unsigned int i = 0; i < m_results.size(); ++i ){
+    
+    if( converged( i ) ) ++nConverged;
+  }
+  
+  // if no fit converged choose the best of all of them
+  for( unsigned int i = 0; i < m_results.size(); ++i ){
+    
+    if( nConverged > 0 && !converged( i ) ) continue;
+    
+    if( m_bestStart < 0 ||
+        m_results[i]->likelihood() < m_results[m_bestStart]->likelihood() ){
+      
+      m_bestStart = i;
+    }
+  }
+  
+  if( nConverged == 0 ){
+    
+    report( WARNING, kModule ) << "None of the " << m_results.size()
+    << " fits converged." << endl;
+  }
+  
+  report( INFO, kModule ) << nConverged << " of " << m_results.size()
+  << " fits converged.  The best fit is fit " << m_bestStart
+  << " with -2 ln(L) = " << m_results[m_bestStart]->likelihood() << endl;
+  
+  return nConverged;
+}
+
+void
+MultiStartFit::clearResults(){
+  
+  for( vector< FitResults* >::iterator result = m_results.begin();
+       result != m_results.end(); ++result ){
+    
+    delete *result;
+  }
+  
+  m_results.clear();
+  m_bestStart = -1;
+}
@@ -0,0 +1,173 @@
+#if !(defined MULTISTARTFIT)
+#define MULTISTARTFIT
+
+//******************************************************************************
+// This file is part of AmpTools, a package for performing Amplitude Analysis
+// 
+// Copyright Trustees of Indiana University 2010, all rights reserved
+// 
+// This software written by Matthew Shepherd, Ryan Mitchell, and 
+//                  Hrayr Matevosyan at Indiana University, Bloomington
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice and author attribution, this list of conditions and the
+//    following disclaimer. 
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice and author attribution, this list of conditions and the
+//    following disclaimer in the documentation and/or other materials
+//    provided with the distribution.
+// 3. Neither the name of the University nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// 
+// Creation of derivative forms of this software for commercial
+// utilization may be subject to restriction; written permission may be
+// obtained from the Trustees of Indiana University.
+// 
+// INDIANA UNIVERSITY AND THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, 
+// EXPRESS OR IMPLIED.  By way of example, but not limitation, INDIANA 
+// UNIVERSITY MAKES NO REPRESENTATIONS OR WARRANTIES OF MERCANTABILITY OR 
+// FITNESS FOR ANY PARTICULAR PURPOSE OR THAT THE USE OF THIS SOFTWARE OR 
+// DOCUMENTATION WILL NOT INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS, 
+// OR OTHER RIGHTS.  Neither Indiana University nor the authors shall be 
+// held liable for any liability with respect to any claim by the user or 
+// any other party arising from use of the program.
+//******************************************************************************
+
+#include <vector>
+#include <string>
+#include <utility>
+
+class ConfigurationInfo;
+class FitResults;
+
+using namespace std;
+
+/**
+ * This class performs many fits of the same configuration from randomized
+ * starting values in one process, which is the usual way to look for the
+ * global minimum of the likelihood.  The data, background, and Monte Carlo
+ * samples are read once, using AmpToolsInterface::setPreloadThreads threads
+ * if it is set, and the user variables are computed once.  Several
+ * fits then run concurrently, each on its own thread with its own
+ * AmpToolsInterface, and therefore its own parameters, minimizer, and
+ * amplitude calculations, while the four-vectors and user variables are
+ * shared read-only by all of them.
+ *
+ * The terms and intensities of the data, background, and accepted MC,
+ * and the terms of the generated MC, which is held in memory rather than
+ * read in pieces, are allocated for each concurrent fit.  The memory
+ * needed for these grows with the number of concurrent fits.
+ *
+ * Start i randomizes the production parameters, and any parameters
+ * requested with randomizeParameter, using random stream i of the seed,
+ * so the starting values do not depend on the number of concurrent fits
+ * or on the order in which the starts are run.
+ *
+ * The results of all starts are written in order to one binary FitResults
+ * file.  A fit is considered converged if the last MINUIT command succeeded
+ * and the error matrix is accurate, and the best fit is the converged fit
+ * with the lowest -2 ln L.
+ *
+ * With setBootstrap each start instead fits bootstrap replica i of the
+ * data, made by resampling the data and background events with
+ * replacement, and by default starts from the values in the configuration.
+ * The data are still read once for all replicas, and unless a term has a
+ * free parameter the amplitudes are also computed only once.  The spread
+ * of the results is a bootstrap estimate of the uncertainties of the
+ * parameters.
+ *
+ * Each fit uses the EventLoopThreads threads for its own loops over events,
+ * so the product of the number of concurrent fits and the number of event
+ * loop threads should not exceed the number of cores.  This class does not
+ * support MPI or GPU acceleration.
+ *
+ * \ingroup IUAmpTools
+ */
+
+class MultiStartFit
+{
+  
+public:
+  
+  MultiStartFit( ConfigurationInfo* cfgInfo );
+  ~MultiStartFit();
+  
+  void setNumStarts( unsigned int nStarts ) { m_numStarts = nStarts; }
+  
+  /**
+   * The number of fits to run at once.  Zero (the default) divides the
+   * hardware threads by the number of EventLoopThreads threads.
+   */
+  void setNumConcurrentFits( unsigned int nFits ) { m_numConcurrent = nFits; }
+  
+  void setSeed( unsigned long long seed ) { m_seed = seed; }
+  
+  // the arguments of the randomization functions of AmpToolsInterface
+  void setMaxFitFraction( float maxFitFraction ) { m_maxFitFraction = maxFitFraction; }
+  void randomizeParameter( const string& parName, float min, float max );
+  
+  /**
+   * Fit bootstrap replica i of the data in start i rather than the data.
+   * This also turns off the randomization of the starting values, which
+   * can be turned back on with setRandomizeStarts.
+   *
+   * \see AmpToolsInterface::setBootstrapReplica
+   */
+  void setBootstrap( bool bootstrap );
+  void setRandomizeStarts( bool randomize ) { m_randomizeStarts = randomize; }
+  
+  void setStrategy( int strategy ) { m_strategy = strategy; }
+  void setRunHesse( bool runHesse ) { m_runHesse = runHesse; }
+  
+  /**
+   * Perform all of the fits and write the results to a binary file.
+   * Returns the number of fits that converged.
+   *
+   * \param[in] fileName the name of the output file
+   *
+   * \see FitResults::writeBinaryResults
+   */
+  unsigned int fit( const string& fileName );
+  
+  unsigned int numStarts() const { return m_results.size(); }
+  
+  // the results of the last call to fit, in the order of the starts
+  const FitResults* fitResults( unsigned int iStart ) const;
+  bool converged( unsigned int iStart ) const;
+  
+  // the index of the best fit, or -1 if no fit has been done
+  int bestStart() const { return m_bestStart; }
+  const FitResults* bestFit() const;
+  
+private:
+  
+  // no copying of this object
+  MultiStartFit( const MultiStartFit& );
+  MultiStartFit& operator=( const MultiStartFit& );
+  
+  void clearResults();
+  
+  ConfigurationInfo* m_cfgInfo;
+  
+  unsigned int m_numStarts;
+  unsigned int m_numConcurrent;
+  unsigned long long m_seed;
+  float m_maxFitFraction;
+  int m_strategy;
+  bool m_runHesse;
+  bool m_bootstrap;
+  bool m_randomizeStarts;
+  
+  vector< pair< string, pair< float, float > > > m_randomPars;
+  
+  vector< FitResults* > m_results;
+  int m_bestStart;
+  
+  static const char* kModule;
+};
+
+#endif
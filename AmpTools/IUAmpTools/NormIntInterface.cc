@@ -43,11 +43,38 @@
 #include <cassert>
 #include <cstring>
 #include <iomanip>
+#include <sstream>
+#include <cstdio>
+#include <algorithm>
+
+#include <unistd.h>
 
 #include "IUAmpTools/NormIntInterface.h"
+#include "IUAmpTools/MappedFile.h"
 #include "IUAmpTools/report.h"
 const char* NormIntInterface::kModule = "NormIntInterface";
 
+bool NormIntInterface::m_binaryExport = false;
+
+// The binary cache file starts with this header, which is followed by
+// the term names (each terminated by a null character and the block padded
+// to a multiple of eight bytes), the upper triangle of the amplitude
+// integral matrix stored row by row as pairs of real and imaginary parts,
+// and then the upper triangle of the normalization integral matrix.
+
+struct NormIntCacheHeader {
+  
+  char magic[8];
+  unsigned int version;
+  unsigned int numTerms;
+  unsigned long long nGenEvents;
+  double sumAccWeights;
+  unsigned long long namesLength;
+};
+
+static const char kNormIntMagic[8] = { 'A', 'M', 'P', 'N', 'O', 'R', 'M', '\0' };
+static const unsigned int kNormIntVersion = 1;
+
 #ifndef __ACLIC__
 #include "IUAmpTools/AmplitudeManager.h"
 #include "IUAmpTools/Kinematics.h"
@@ -61,7 +88,9 @@ m_accMCReader( NULL ),
 m_genMCReader( NULL ),
 #endif
 m_emptyNormIntCache( true ),
-m_emptyAmpIntCache( true )
+m_emptyAmpIntCache( true ),
+m_nGenEvents( 0 ),
+m_sumAccWeights( 0 )
 {}
 
 NormIntInterface::NormIntInterface( const string& normIntFile ) :
@@ -77,6 +106,24 @@ m_emptyAmpIntCache( true )
   report( INFO, kModule ) << "Reading cached normalization integral calculation from: "
        << normIntFile << endl;
   
+  // map the file first to see if it is a binary cache
+  {
+    MappedFile file( normIntFile );
+    
+    if( file.isValid() && file.size() >= sizeof( kNormIntMagic ) &&
+        memcmp( file.data(), kNormIntMagic, sizeof( kNormIntMagic ) ) == 0 ){
+      
+      if( !loadBinaryNormIntCache( file.data(), file.size() ) ){
+        
+        report( ERROR, kModule ) << "File " << normIntFile
+        << " is not a valid binary normalization integral cache." << endl;
+        assert( false );
+      }
+      
+      return;
+    }
+  }
+  
   ifstream inFile( normIntFile.c_str() );
   
   if( !inFile ){
@@ -102,22 +149,9 @@ m_termNames( intenManager.getTermNames() )
   
   m_termNames = intenManager.getTermNames();
   
-  std::map<DataReader*,AmpVecs*>::iterator genVecs = m_uniqueDataSets.find( m_genMCReader );
-  if( genVecs == m_uniqueDataSets.end() ){
-  
-    report( INFO, kModule ) << "Loading generated Monte Carlo from file..." << endl;
-    m_genMCVecs.loadData( m_genMCReader );
-    
-    m_uniqueDataSets[m_genMCReader] = &m_genMCVecs;
-  }
-  else{
-    
-    report( NOTICE, kModule ) << "Duplicated Monte Carlo set detected, "
-         << "using previously loaded version" << endl;
-    
-    genVecs->second->shareDataWith( &m_genMCVecs );
-  }
-  m_nGenEvents = m_genMCVecs.m_iNTrueEvents;
+  // the generated MC is only needed for the amplitude integrals, so
+  // it is not loaded until they are computed -- see calcGenMCIntegrals
+  m_nGenEvents = m_genMCReader->numEvents();
 
   std::map<DataReader*,AmpVecs*>::iterator accVecs = m_uniqueDataSets.find( m_accMCReader );
   if( accVecs == m_uniqueDataSets.end() ){
@@ -213,57 +247,157 @@ NormIntInterface::loadNormIntCache( istream& input )
   return input;
 }
 
+bool
+NormIntInterface::loadBinaryNormIntCache( const char* data, unsigned long long size )
+{
+  if( size < sizeof( NormIntCacheHeader ) ) return false;
+  
+  const NormIntCacheHeader* header =
+    reinterpret_cast< const NormIntCacheHeader* >( data );
+  
+  if( memcmp( header->magic, kNormIntMagic, sizeof( kNormIntMagic ) ) != 0 ||
+      header->version != kNormIntVersion ) return false;
+  
+  unsigned long long n = header->numTerms;
+  unsigned long long nPacked = n * ( n + 1 ) / 2;
+  
+  if( size != sizeof( NormIntCacheHeader ) + header->namesLength +
+              2 * 2 * nPacked * sizeof( double ) ) return false;
+  
+  m_nGenEvents = header->nGenEvents;
+  m_sumAccWeights = header->sumAccWeights;
+  
+  m_termNames.clear();
+  m_termIndex.clear();
+  
+  const char* name = data + sizeof( NormIntCacheHeader );
+  const char* namesEnd = name + header->namesLength;
+  
+  for( unsigned long long i = 0; i < n; ++i ){
+    
+    const char* nameEnd = static_cast< const char* >( memchr( name, '\0', namesEnd - name ) );
+    if( nameEnd == NULL ) return false;
+    
+    m_termNames.push_back( string( name, nameEnd ) );
+    name = nameEnd + 1;
+  }
+  
+  initializeCache();
+  
+  const double* packed[2];
+  packed[0] = reinterpret_cast< const double* >( namesEnd );
+  packed[1] = packed[0] + 2 * nPacked;
+  
+  double* cache[2] = { m_ampIntCache, m_normIntCache };
+  
+  for( int m = 0; m < 2; ++m ){
+    
+    const double* value = packed[m];
+    
+    for( unsigned long long i = 0; i < n; ++i ){
+      for( unsigned long long j = i; j < n; ++j ){
+        
+        cache[m][2*i*n+2*j]   = value[0];
+        cache[m][2*i*n+2*j+1] = value[1];
+        
+        // the lower triangle is the complex conjugate
+        cache[m][2*j*n+2*i]   = value[0];
+        cache[m][2*j*n+2*i+1] = ( i == j ? value[1] : -value[1] );
+        
+        value += 2;
+      }
+    }
+  }
+  
+  m_emptyNormIntCache = false;
+  m_emptyAmpIntCache = false;
+  
+  return true;
+}
+
 void
 NormIntInterface::operator+=( const NormIntInterface& nii )
 {
   
-  double nAccEvts = nii.numAccEvents();
-  double nGenEvts = nii.numGenEvents();
+  // both integrals are sums over events divided by the number of generated
+  // events, so the integrals of the combined sample are the averages of
+  // the two weighted by the number of generated events in each
   
-  double totalAccEvts = nAccEvts + m_sumAccWeights;
+  double nGenEvts = nii.numGenEvents();
   double totalGenEvts = nGenEvts + m_nGenEvents;
   
-  string ampName, conjAmpName;
-  
   int n = m_termNames.size();
   
+  // an empty interface just takes on the contents of the other
+  if( n == 0 ){
+    
+    m_termNames = nii.m_termNames;
+    n = m_termNames.size();
+    
+    initializeCache();
+  }
+  
+  if( n != nii.numTerms() ){
+    
+    report( ERROR, kModule ) << "Cannot add normalization integrals with "
+    << nii.numTerms() << " terms to integrals with " << n << " terms." << endl;
+    assert( false );
+  }
+  
+  if( totalGenEvts == 0 ) return;
+  
   for( int i = 0; i < n; ++i ){
     for( int j = 0; j < n; ++j ){
-    
-      m_ampIntCache[2*i*n+j]   *= m_sumAccWeights;
-      m_ampIntCache[2*i*n+j+1] *= m_sumAccWeights;
-
-      complex< double > ai = nii.ampInt( m_termNames[i], m_termNames[j]  );
-      
-      m_ampIntCache[2*i*n+j]   += nAccEvts * real( ai );
-      m_ampIntCache[2*i*n+j+1] += nAccEvts * imag( ai );
-
-      m_ampIntCache[2*i*n+j]   /= totalAccEvts;
-      m_ampIntCache[2*i*n+j+1] /= totalAccEvts;
-
       
-      m_ampIntCache[2*i*n+j]   *= m_nGenEvents;
-      m_ampIntCache[2*i*n+j+1] *= m_nGenEvents;
+      complex< double > ai = nii.ampInt( m_termNames[i], m_termNames[j], true );
+      complex< double > ni = nii.normInt( m_termNames[i], m_termNames[j], true );
       
-      complex< double > ni = nii.normInt( m_termNames[i], m_termNames[j]  );
-      
-      m_ampIntCache[2*i*n+j]   += nGenEvts * real( ni );
-      m_ampIntCache[2*i*n+j+1] += nGenEvts * imag( ni );
-      
-      m_ampIntCache[2*i*n+j]   /= totalGenEvts;
-      m_ampIntCache[2*i*n+j+1] /= totalGenEvts;
+      m_ampIntCache[2*i*n+2*j] =
+        ( m_nGenEvents * m_ampIntCache[2*i*n+2*j] + nGenEvts * real( ai ) ) / totalGenEvts;
+      m_ampIntCache[2*i*n+2*j+1] =
+        ( m_nGenEvents * m_ampIntCache[2*i*n+2*j+1] + nGenEvts * imag( ai ) ) / totalGenEvts;
       
+      m_normIntCache[2*i*n+2*j] =
+        ( m_nGenEvents * m_normIntCache[2*i*n+2*j] + nGenEvts * real( ni ) ) / totalGenEvts;
+      m_normIntCache[2*i*n+2*j+1] =
+        ( m_nGenEvents * m_normIntCache[2*i*n+2*j+1] + nGenEvts * imag( ni ) ) / totalGenEvts;
     }
   }
   
-  
-  m_sumAccWeights = totalAccEvts;
-  m_nGenEvents = totalGenEvts;
+  m_sumAccWeights += nii.numAccEvents();
+  m_nGenEvents += nii.numGenEvents();
   
   m_emptyNormIntCache = false;
   m_emptyAmpIntCache = false;
 }
 
+void
+NormIntInterface::mergeNormIntFiles( const vector< string >& inputFiles,
+                                     const string& outputFile )
+{
+  
+  if( inputFiles.empty() ){
+    
+    report( ERROR, kModule ) << "No normalization integral files to merge." << endl;
+    assert( false );
+  }
+  
+  NormIntInterface merged;
+  
+  for( vector< string >::const_iterator file = inputFiles.begin();
+       file != inputFiles.end(); ++file ){
+    
+    NormIntInterface shard( *file );
+    merged += shard;
+  }
+  
+  report( INFO, kModule ) << "Writing integrals for " << merged.numGenEvents()
+  << " generated events from " << inputFiles.size() << " files to: "
+  << outputFile << endl;
+  
+  merged.exportNormIntCache( outputFile );
+}
+
 bool
 NormIntInterface::hasNormInt( string amp, string conjAmp ) const
 {
@@ -424,20 +558,10 @@ NormIntInterface::forceCacheUpdate( bool normIntOnly ) const
   if( !normIntOnly &&
       ( m_emptyAmpIntCache || m_pIntenManager->hasTermWithFreeParam() ) ){
       
-    // now we need to have the generated MC in addition to the accepted
-    // MC in order to be able to continue
-    assert( m_genMCVecs.m_dataLoaded );
-
-    // do "lazy" allocation of memory here -- this is important for MPI jobs
-    // where forceCacheUpdate is only called on follower nodes, as it
-    // avoids big memory allocations on the lead nodes
-    if( m_genMCVecs.m_iNTerms == 0 ) m_genMCVecs.allocateTerms( *m_pIntenManager );
-    
     report( DEBUG, kModule ) << "Asking IntensityManager to calculate integrals "
     << "using the generated MC." << endl;
     
-    m_pIntenManager->calcIntegrals( m_genMCVecs, m_nGenEvents );
-    setAmpIntMatrix( m_genMCVecs.m_pdIntegralMatrix );
+    calcGenMCIntegrals();
   
     m_emptyAmpIntCache = false;
   }
@@ -460,14 +584,148 @@ NormIntInterface::forceCacheUpdate( bool normIntOnly ) const
   m_emptyNormIntCache = false;
 }
 
+void
+NormIntInterface::calcGenMCIntegrals() const
+{
+  
+  // with perfect acceptance the generated MC is already loaded
+  if( m_accMCReader == m_genMCReader ){
+    
+    m_pIntenManager->calcIntegrals( m_accMCVecs, m_nGenEvents );
+    setAmpIntMatrix( m_accMCVecs.m_pdIntegralMatrix );
+    return;
+  }
+  
+  loadGenMC();
+  
+  if( m_genMCVecs.m_dataLoaded ){
+    
+    // do "lazy" allocation of memory here -- this is important for MPI jobs
+    // where forceCacheUpdate is only called on follower nodes, as it
+    // avoids big memory allocations on the lead nodes
+    if( m_genMCVecs.m_iNTerms == 0 ) m_genMCVecs.allocateTerms( *m_pIntenManager );
+    
+    m_pIntenManager->calcIntegrals( m_genMCVecs, m_nGenEvents );
+    setAmpIntMatrix( m_genMCVecs.m_pdIntegralMatrix );
+    return;
+  }
+  
+  // otherwise read the generated MC in pieces -- each piece is normalized
+  // to the total number of generated events so the integrals are the
+  // sum of the integrals of the pieces
+  
+  report( INFO, kModule ) << "Integrating generated Monte Carlo from file in "
+  << "pieces of " << m_genMCChunkSize << " events..." << endl;
+  
+  vector< double > ampInt( m_cacheSize, 0 );
+  
+  m_genMCReader->resetSource();
+  unsigned long long nEvents = m_genMCReader->numEvents();
+  unsigned long long nRead = 0;
+  
+  while( nRead < nEvents ){
+    
+    AmpVecs chunk;
+    unsigned long long nChunk =
+      chunk.loadNextEvents( m_genMCReader,
+                            min( m_genMCChunkSize, nEvents - nRead ) );
+    
+    if( nChunk == 0 ){
+      
+      report( ERROR, kModule ) << m_genMCReader->name() << " provided " << nRead
+      << " events but reported " << nEvents << " events." << endl;
+      assert( false );
+    }
+    
+    nRead += nChunk;
+    
+    chunk.allocateTerms( *m_pIntenManager );
+    m_pIntenManager->calcIntegrals( chunk, m_nGenEvents );
+    
+    for( int k = 0; k < m_cacheSize; ++k ){
+      
+      ampInt[k] += chunk.m_pdIntegralMatrix[k];
+    }
+  }
+  
+  setAmpIntMatrix( &(ampInt[0]) );
+}
+
 #endif
 
 void
 NormIntInterface::exportNormIntCache( const string& fileName ) const
 {
-  ofstream out( fileName.c_str() );
-  out.precision( 15 );
-  exportNormIntCache( out );
+  ostringstream tmpName;
+  tmpName << fileName << ".tmp" << getpid();
+  
+  {
+    ofstream out( tmpName.str().c_str(),
+                  m_binaryExport ? ios::out | ios::binary : ios::out );
+    
+    if( !out ){
+      
+      report( ERROR, kModule ) << "Unable to write file " << tmpName.str() << endl;
+      return;
+    }
+    
+    if( m_binaryExport ){
+      
+      exportBinaryNormIntCache( out );
+    }
+    else{
+      
+      out.precision( 15 );
+      exportNormIntCache( out );
+    }
+  }
+  
+  if( rename( tmpName.str().c_str(), fileName.c_str() ) != 0 ){
+    
+    report( ERROR, kModule ) << "Unable to rename " << tmpName.str()
+    << " to " << fileName << endl;
+    remove( tmpName.str().c_str() );
+  }
+}
+
+void
+NormIntInterface::exportBinaryNormIntCache( ostream& out ) const
+{
+  string names;
+  for( vector< string >::const_iterator name = m_termNames.begin();
+       name != m_termNames.end();
+       ++name ){
+    
+    names += *name;
+    names += '\0';
+  }
+  
+  // pad the names so the matrices are aligned
+  names.resize( 8 * ( ( names.size() + 7 ) / 8 ), '\0' );
+  
+  NormIntCacheHeader header;
+  memset( &header, 0, sizeof( header ) );
+  memcpy( header.magic, kNormIntMagic, sizeof( kNormIntMagic ) );
+  header.version = kNormIntVersion;
+  header.numTerms = m_termNames.size();
+  header.nGenEvents = m_nGenEvents;
+  header.sumAccWeights = m_sumAccWeights;
+  header.namesLength = names.size();
+  
+  out.write( reinterpret_cast< const char* >( &header ), sizeof( header ) );
+  out.write( names.data(), names.size() );
+  
+  int n = m_termNames.size();
+  const double* cache[2] = { m_ampIntCache, m_normIntCache };
+  
+  for( int m = 0; m < 2; ++m ){
+    for( int i = 0; i < n; ++i ){
+      
+      // the elements j >= i of row i are contiguous
+      out.write( reinterpret_cast< const char* >( &cache[m][2*i*n+2*i] ),
+                 2 * ( n - i ) * sizeof( double ) );
+    }
+  }
 }
 
 void
@@ -554,6 +812,51 @@ NormIntInterface::setNormIntMatrix( const double* input ) const {
 
 
 #ifndef __ACLIC__
+void
+NormIntInterface::loadGenMC() const
+{
+  if( m_genMCVecs.m_dataLoaded ) return;
+  
+  // use the data directly if they are already in memory, e.g., if
+  // the same sample is the accepted MC for another interface
+  std::map<DataReader*,AmpVecs*>::iterator genVecs = m_uniqueDataSets.find( m_genMCReader );
+  if( genVecs != m_uniqueDataSets.end() ){
+    
+    report( NOTICE, kModule ) << "Duplicated Monte Carlo set detected, "
+         << "using previously loaded version" << endl;
+    
+    genVecs->second->shareDataWith( &m_genMCVecs );
+  }
+  else if( m_genMCChunkSize == 0 || AmpVecs::hasValidCache( m_genMCReader ) ){
+    
+    // a copy in the cache is mapped rather than read, and it may be the
+    // only source of the events, e.g., for a follower in an MPI job
+    report( INFO, kModule ) << "Loading generated Monte Carlo from file..." << endl;
+    m_genMCVecs.loadData( m_genMCReader );
+    
+    m_uniqueDataSets[m_genMCReader] = &m_genMCVecs;
+  }
+}
+
+void
+NormIntInterface::shareUserVars( const NormIntInterface& source ){
+  
+  if( m_accMCVecs.m_iNTerms == 0 ) m_accMCVecs.allocateTerms( *m_pIntenManager );
+  m_accMCVecs.shareUserVars( source.m_accMCVecs );
+  
+  // the generated MC is only in memory if it was not read in pieces
+  if( m_accMCReader != m_genMCReader && source.m_genMCVecs.m_iNTerms > 0 ){
+    
+    loadGenMC();
+    
+    if( m_genMCVecs.m_dataLoaded ){
+      
+      if( m_genMCVecs.m_iNTerms == 0 ) m_genMCVecs.allocateTerms( *m_pIntenManager );
+      m_genMCVecs.shareUserVars( source.m_genMCVecs );
+    }
+  }
+}
+
 void
 NormIntInterface::invalidateTerms(){
   
@@ -565,5 +868,6 @@ NormIntInterface::invalidateTerms(){
 }
 
 map< DataReader*, AmpVecs* > NormIntInterface::m_uniqueDataSets;
+unsigned long long NormIntInterface::m_genMCChunkSize = 1000000;
 #endif
 
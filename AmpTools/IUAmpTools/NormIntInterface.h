@@ -67,8 +67,17 @@ public:
 #endif
 
   istream& loadNormIntCache( istream& in );
+  
+  // combine with integrals computed from an independent sample of MC
+  // generated with the same amplitudes -- the result is identical to
+  // the integrals computed from the union of the two samples
   void operator+=( const NormIntInterface& nii );
   
+  // combine files written by independent jobs that each processed
+  // a part of the MC into a single file for the same amplitudes
+  static void mergeNormIntFiles( const vector< string >& inputFiles,
+                                 const string& outputFile );
+  
   unsigned long int numGenEvents() const { return m_nGenEvents; }
   double numAccEvents() const { return m_sumAccWeights; }
   
@@ -90,12 +99,41 @@ public:
   virtual void forceCacheUpdate( bool normIntOnly = false ) const;
   
   void invalidateTerms();
+  
+  // use the user variables of the accepted and generated MC that were
+  // computed by another interface for the same samples and intensity
+  // manager -- the source must remain allocated while this one is used
+  void shareUserVars( const NormIntInterface& source );
+
+  // the generated MC is not read until the amplitude integrals are first
+  // needed, and then it is read and integrated in pieces of at most this
+  // many events so the full sample is never held in memory -- zero reads
+  // the entire sample at once, as does a valid copy in the data cache,
+  // which is mapped rather than read
+  static void setGenMCChunkSize( unsigned long long events ) {
+    m_genMCChunkSize = events; }
+  static unsigned long long genMCChunkSize() { return m_genMCChunkSize; }
 
 #endif
   
+  // the file is written to a temporary name and then renamed so that
+  // other jobs never read a partially written file -- the format is
+  // binary if setBinaryExport( true ) has been called
   void exportNormIntCache( const string& fileName ) const;
   void exportNormIntCache( ostream& output ) const;
   
+  // write the integrals as a header with the term names followed by the
+  // upper triangles of the (hermitian) matrices -- files in this format
+  // are recognized automatically and mapped rather than parsed when
+  // passed to the constructor
+  void exportBinaryNormIntCache( ostream& output ) const;
+  
+  static void setBinaryExport( bool binary ) { m_binaryExport = binary; }
+  
+  // read integrals in the binary format from a block of memory,
+  // returns false if the block is not a valid binary cache
+  bool loadBinaryNormIntCache( const char* data, unsigned long long size );
+  
   // allow direct access to raw data matrix in memory, which is useful
   // for high-speed implementations, but not user friendly
   const double* ampIntMatrix() const  { return m_ampIntCache;  }
@@ -113,6 +151,12 @@ protected:
 #endif
   
   inline int cacheSize() const { return m_cacheSize; }
+  inline int numTerms() const { return m_termNames.size(); }
+  
+#ifndef __ACLIC__
+  AmpVecs& accMCVecs() const { return m_accMCVecs; }
+  AmpVecs& genMCVecs() const { return m_genMCVecs; }
+#endif
   
   void setAmpIntMatrix( const double* input ) const;
   void setNormIntMatrix( const double* input ) const;
@@ -122,6 +166,11 @@ private:
   void initializeCache();
   int m_cacheSize;
   
+#ifndef __ACLIC__
+  void calcGenMCIntegrals() const;
+  void loadGenMC() const;
+#endif
+  
   vector< string > m_termNames;
   map< string, int > m_termIndex;
   
@@ -146,8 +195,11 @@ private:
   mutable AmpVecs m_genMCVecs;
   
   static map< DataReader*, AmpVecs* > m_uniqueDataSets;
+  static unsigned long long m_genMCChunkSize;
 #endif
   
+  static bool m_binaryExport;
+  
   static const char* kModule;
 };
 
@@ -0,0 +1,194 @@
+//******************************************************************************
+// This file is part of AmpTools, a package for performing Amplitude Analysis
+// 
+// Copyright Trustees of Indiana University 2010, all rights reserved
+// 
+// This software written by Matthew Shepherd, Ryan Mitchell, and 
+//                  Hrayr Matevosyan at Indiana University, Bloomington
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice and author attribution, this list of conditions and the
+//    following disclaimer. 
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice and author attribution, this list of conditions and the
+//    following disclaimer in the documentation and/or other materials
+//    provided with the distribution.
+// 3. Neither the name of the University nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// 
+// Creation of derivative forms of this software for commercial
+// utilization may be subject to restriction; written permission may be
+// obtained from the Trustees of Indiana University.
+// 
+// INDIANA UNIVERSITY AND THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, 
+// EXPRESS OR IMPLIED.  By way of example, but not limitation, INDIANA 
+// UNIVERSITY MAKES NO REPRESENTATIONS OR WARRANTIES OF MERCANTABILITY OR 
+// FITNESS FOR ANY PARTICULAR PURPOSE OR THAT THE USE OF THIS SOFTWARE OR 
+// DOCUMENTATION WILL NOT INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS, 
+// OR OTHER RIGHTS.  Neither Indiana University nor the authors shall be 
+// held liable for any liability with respect to any claim by the user or 
+// any other party arising from use of the program.
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cassert>
+
+#include "TFile.h"
+#include "TH1.h"
+
+#include "IUAmpTools/PlotBatch.h"
+#include "IUAmpTools/PlotGenerator.h"
+#include "IUAmpTools/Histogram.h"
+
+#include "IUAmpTools/report.h"
+const char* PlotBatch::kModule = "PlotBatch";
+
+PlotBatch::PlotBatch( PlotGenerator& plotGenerator ) :
+m_plotGenerator( plotGenerator )
+{}
+
+void
+PlotBatch::addConfiguration( const string& name, const vector< string >& enabled ){
+  
+  const vector< string >& amps = m_plotGenerator.uniqueAmplitudes();
+  const vector< string >& sums = m_plotGenerator.uniqueSums();
+  
+  for( vector< string >::const_iterator item = enabled.begin();
+       item != enabled.end(); ++item ){
+    
+    if( find( amps.begin(), amps.end(), *item ) == amps.end() &&
+        find( sums.begin(), sums.end(), *item ) == sums.end() ){
+      
+      report( ERROR, kModule ) << "Configuration " << name << " enables " << *item
+      << ", which is not an amplitude or sum." << endl;
+      assert( false );
+    }
+  }
+  
+  m_configurations.push_back( pair< string, vector< string > >( name, enabled ) );
+}
+
+void
+PlotBatch::addAmplitudeConfigurations(){
+  
+  addConfiguration( "all", vector< string >() );
+  
+  const vector< string >& amps = m_plotGenerator.uniqueAmplitudes();
+  for( vector< string >::const_iterator amp = amps.begin();
+       amp != amps.end(); ++amp ){
+    
+    addConfiguration( *amp, vector< string >( 1, *amp ) );
+  }
+}
+
+void
+PlotBatch::addReaction( const string& reactName ){
+  
+  m_reactions.push_back( reactName );
+}
+
+void
+PlotBatch::setConfiguration( const vector< string >& enabled ){
+  
+  const vector< string >& amps = m_plotGenerator.uniqueAmplitudes();
+  const vector< string >& sums = m_plotGenerator.uniqueSums();
+  
+  bool anyAmp = false;
+  bool anySum = false;
+  for( vector< string >::const_iterator item = enabled.begin();
+       item != enabled.end(); ++item ){
+    
+    if( find( amps.begin(), amps.end(), *item ) != amps.end() ) anyAmp = true;
+    if( find( sums.begin(), sums.end(), *item ) != sums.end() ) anySum = true;
+  }
+  
+  for( unsigned int i = 0; i < amps.size(); ++i ){
+    
+    if( !anyAmp || find( enabled.begin(), enabled.end(), amps[i] ) != enabled.end() )
+      m_plotGenerator.enableAmp( i );
+    else
+      m_plotGenerator.disableAmp( i );
+  }
+  
+  for( unsigned int i = 0; i < sums.size(); ++i ){
+    
+    if( !anySum || find( enabled.begin(), enabled.end(), sums[i] ) != enabled.end() )
+      m_plotGenerator.enableSum( i );
+    else
+      m_plotGenerator.disableSum( i );
+  }
+}
+
+void
+PlotBatch::writePlots( const string& fileName ){
+  
+  vector< string > reactions =
+    ( m_reactions.empty() ? m_plotGenerator.reactions() : m_reactions );
+  
+  if( m_configurations.empty() ) addAmplitudeConfigurations();
+  
+  TH1::AddDirectory( kFALSE );
+  TFile file( fileName.c_str(), "recreate" );
+  
+  const char* typeNames[PlotGenerator::kNumTypes] = { "dat", "bkg", "gen", "acc" };
+  
+  unsigned int nPlots = m_plotGenerator.availablePlots().size();
+  unsigned int nWritten = 0;
+  
+  // the data and background are the same for every configuration, and
+  // the remaining loops are over the MC
+  
+  for( int iConfig = -1; iConfig < (int)m_configurations.size(); ++iConfig ){
+    
+    if( iConfig >= 0 ) setConfiguration( m_configurations[iConfig].second );
+    
+    for( vector< string >::const_iterator reaction = reactions.begin();
+         reaction != reactions.end(); ++reaction ){
+      
+      m_plotGenerator.enableReaction( *reaction );
+      
+      for( unsigned int type = 0; type < PlotGenerator::kNumTypes; ++type ){
+        
+        bool isDataOrBkgnd = ( type == PlotGenerator::kData ||
+                               type == PlotGenerator::kBkgnd );
+        
+        if( isDataOrBkgnd != ( iConfig < 0 ) ) continue;
+        if( type == PlotGenerator::kBkgnd && !m_plotGenerator.hasBackground() ) continue;
+        if( type == PlotGenerator::kGenMC && !m_plotGenerator.isGenMCEnabled() ) continue;
+        
+        for( unsigned int iPlot = 0; iPlot < nPlots; ++iPlot ){
+          
+          Histogram* hist = m_plotGenerator.projection( iPlot, *reaction, type );
+          if( hist == NULL ) continue;
+          
+          string histName = *reaction + "_";
+          if( iConfig >= 0 ) histName += m_configurations[iConfig].first + "_";
+          histName += string( typeNames[type] ) + "_" + hist->name();
+          
+          TH1* rootHist = hist->toRoot();
+          rootHist->SetName( histName.c_str() );
+          
+          file.cd();
+          rootHist->Write();
+          delete rootHist;
+          
+          ++nWritten;
+        }
+      }
+    }
+  }
+  
+  file.Close();
+  
+  // leave everything enabled
+  setConfiguration( vector< string >() );
+  
+  report( INFO, kModule ) << "Wrote " << nWritten << " histograms for "
+  << m_configurations.size() << " configurations and " << reactions.size()
+  << " reactions to " << fileName << endl;
+}
@@ -0,0 +1,93 @@
+#if !(defined PLOTBATCH)
+#define PLOTBATCH
+
+//******************************************************************************
+// This file is part of AmpTools, a package for performing Amplitude Analysis
+// 
+// Copyright Trustees of Indiana University 2010, all rights reserved
+// 
+// This software written by Matthew Shepherd, Ryan Mitchell, and 
+//                  Hrayr Matevosyan at Indiana University, Bloomington
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice and author attribution, this list of conditions and the
+//    following disclaimer. 
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice and author attribution, this list of conditions and the
+//    following disclaimer in the documentation and/or other materials
+//    provided with the distribution.
+// 3. Neither the name of the University nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// 
+// Creation of derivative forms of this software for commercial
+// utilization may be subject to restriction; written permission may be
+// obtained from the Trustees of Indiana University.
+// 
+// INDIANA UNIVERSITY AND THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES, 
+// EXPRESS OR IMPLIED.  By way of example, but not limitation, INDIANA 
+// UNIVERSITY MAKES NO REPRESENTATIONS OR WARRANTIES OF MERCANTABILITY OR 
+// FITNESS FOR ANY PARTICULAR PURPOSE OR THAT THE USE OF THIS SOFTWARE OR 
+// DOCUMENTATION WILL NOT INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS, 
+// OR OTHER RIGHTS.  Neither Indiana University nor the authors shall be 
+// held liable for any liability with respect to any claim by the user or 
+// any other party arising from use of the program.
+
+#include <vector>
+#include <string>
+#include <utility>
+
+using namespace std;
+
+class PlotGenerator;
+
+// PlotBatch makes the projections of a PlotGenerator for a list of
+// amplitude configurations and reactions without any user interaction
+// and writes all of the histograms to a single ROOT file.  A
+// configuration is a name and a list of the unique amplitudes and sums
+// that are enabled -- if no amplitudes (or no sums) are listed then all
+// of them are enabled.  The data and background do not depend on the
+// configuration and are written once for each reaction.  Histograms are
+// named reaction_configuration_type_histogram, e.g., base_all_acc_hm12,
+// or reaction_type_histogram for data and background.
+//
+// The data and MC are loaded once by the PlotGenerator and shared by
+// all configurations, and the projections for each configuration are
+// filled in parallel using the threads set by EventLoopThreads.
+
+class PlotBatch
+{
+  
+public:
+  
+  PlotBatch( PlotGenerator& plotGenerator );
+  
+  // the names can be a mix of unique amplitude and sum names
+  void addConfiguration( const string& name, const vector< string >& enabled );
+  
+  // adds a configuration named "all" with everything enabled and one
+  // for each unique amplitude with only that amplitude enabled
+  void addAmplitudeConfigurations();
+  
+  // by default all reactions in the fit are plotted
+  void addReaction( const string& reactName );
+  
+  // the file is overwritten if it exists
+  void writePlots( const string& fileName );
+  
+private:
+  
+  void setConfiguration( const vector< string >& enabled );
+  
+  PlotGenerator& m_plotGenerator;
+  
+  vector< pair< string, vector< string > > > m_configurations;
+  vector< string > m_reactions;
+  
+  static const char* kModule;
+};
+
+#endif
@@ -47,6 +47,7 @@
 #include "IUAmpTools/NormIntInterface.h"
 #include "IUAmpTools/AmpToolsInterface.h"
 #include "IUAmpTools/FitResults.h"
+#include "IUAmpTools/EventLoopThreads.h"
 
 #include "IUAmpTools/report.h"
 const char* PlotGenerator::kModule = "PlotGenerator";
@@ -67,7 +68,10 @@ m_weightMCByIntensity( true ),
 m_fullAmplitudes( 0 ),
 m_uniqueAmplitudes( 0 ),
 m_histVect( 0 ),
-m_histTitles( 0 )
+m_histTitles( 0 ),
+m_cacheProjections( true ),
+m_recording( NULL ),
+m_recordingEvent( 0 )
 {
 
   vector< string > amps = m_fitResults.ampList();
@@ -173,7 +177,10 @@ PlotGenerator::PlotGenerator( ) :
 m_fitResults( *( new FitResults() ) ),
 m_histVect( 0 ),
 m_histTitles( 0 ),
-m_currentEventWeight( 1 )
+m_currentEventWeight( 1 ),
+m_cacheProjections( false ),
+m_recording( NULL ),
+m_recordingEvent( 0 )
 { }
 
 /*Delete the histograms in the cache*/
@@ -386,8 +393,29 @@ PlotGenerator::fillProjections( const string& reactName, unsigned int type ){
   bool isDataOrBkgnd = ( ( type == kData ) || ( type == kBkgnd ) ? true : false );
   int dataIndex = m_reactIndex[reactName] * kNumTypes + type;
       
-  // calculate intensities for MC:
-  if( !isDataOrBkgnd && m_weightMCByIntensity ) m_ati.processEvents( reactName, dataIndex );
+  // calculate intensities for MC -- the amplitudes were computed in the
+  // constructor and do not change when amplitudes or sums are toggled,
+  // so only the intensities need to be updated for the new production
+  // parameters
+  if( !isDataOrBkgnd && m_weightMCByIntensity )
+    m_ati.processEvents( reactName, dataIndex, false );
+  
+  // the data and background are only projected once, but the MC is
+  // projected for every amplitude configuration -- after the first
+  // time the histograms are refilled from the recorded values
+  if( !isDataOrBkgnd && m_cacheProjections ){
+    
+    map< unsigned int, ProjectionRecord >::const_iterator record =
+      m_projectionRecords.find( dataIndex );
+    
+    if( record != m_projectionRecords.end() ){
+      
+      refillProjections( record->second, dataIndex, m_weightMCByIntensity );
+      return;
+    }
+    
+    m_recording = &(m_projectionRecords[dataIndex]);
+  }
   
   // loop over ampVecs and fill histograms
   for( unsigned int i = 0; i < m_ati.numEvents( dataIndex ); ++i ){
@@ -397,6 +425,12 @@ PlotGenerator::fillProjections( const string& reactName, unsigned int type ){
     Kinematics* kin = m_ati.kinematics(i, dataIndex);
     m_currentEventWeight = kin->weight();
     
+    if( m_recording ){
+      
+      m_recording->eventWeight.push_back( kin->weight() );
+      m_recordingEvent = i;
+    }
+    
     if( !isDataOrBkgnd && m_weightMCByIntensity ){
 
       // m_ati.intensity already contains a possible MC-event weight
@@ -410,25 +444,88 @@ PlotGenerator::fillProjections( const string& reactName, unsigned int type ){
     // cleanup allocated memory
     delete kin;
   }
+  
+  m_recording = NULL;
+}
+
+void
+PlotGenerator::refillProjections( const ProjectionRecord& record,
+                                  unsigned int dataIndex,
+                                  bool weightByIntensity ){
+  
+  // the entries are split into blocks that are filled concurrently, each
+  // into its own empty copies of the histograms, and then the copies are
+  // added to the histograms in block order so that the result does not
+  // depend on the order in which the threads finish
+  
+  unsigned long long nFills = record.fillEvent.size();
+  unsigned int nBlocks = EventLoopThreads::numBlocks( nFills );
+  
+  vector< vector< Histogram* > > blockHists( nBlocks );
+  for( unsigned int iBlock = 0; iBlock < nBlocks; ++iBlock ){
+    for( vector< Histogram* >::iterator hist = m_histVect.begin();
+        hist != m_histVect.end(); ++hist ){
+      
+      Histogram* blockHist = (*hist)->Clone();
+      blockHist->clear();
+      blockHists[iBlock].push_back( blockHist );
+    }
+  }
+  
+  EventLoopThreads::run( nFills,
+    [&]( unsigned int iBlock, unsigned long first, unsigned long last ){
+      
+      vector< Histogram* >& hists = blockHists[iBlock];
+      
+      for( unsigned long iFill = first; iFill < last; ++iFill ){
+        
+        unsigned int iEvent = record.fillEvent[iFill];
+        
+        double weight = ( weightByIntensity ? m_ati.intensity( iEvent, dataIndex ) :
+                          record.eventWeight[iEvent] );
+        
+        hists[record.fillHist[iFill]]->
+          fillValues( record.values.data() + record.fillStart[iFill],
+                      weight * record.fillWeight[iFill] );
+      }
+    } );
+  
+  for( unsigned int iBlock = 0; iBlock < nBlocks; ++iBlock ){
+    for( unsigned int iHist = 0; iHist < m_histVect.size(); ++iHist ){
+      
+      *(m_histVect[iHist]) += *(blockHists[iBlock][iHist]);
+      delete blockHists[iBlock][iHist];
+    }
+  }
+}
+
+void
+PlotGenerator::recordFill( int index, const double* values, unsigned int nValues,
+                           double weight ){
+  
+  m_recording->fillEvent.push_back( m_recordingEvent );
+  m_recording->fillHist.push_back( index );
+  m_recording->fillStart.push_back( m_recording->values.size() );
+  m_recording->fillWeight.push_back( weight );
+  m_recording->values.insert( m_recording->values.end(), values, values + nValues );
 }
 
 void
 PlotGenerator::fillHistogram( int histIndex, double valueX ){
-	vector < double > tmp;
-	tmp.push_back(valueX);
-	m_histVect[histIndex]->fill( tmp, m_currentEventWeight );
+	if( m_recording ) recordFill( histIndex, &valueX, 1, 1 );
+	m_histVect[histIndex]->fillValues( &valueX, m_currentEventWeight );
 }
 
 void
 PlotGenerator::fillHistogram( int histIndex, double valueX,double valueY ){
-	vector < double > tmp;
-	tmp.push_back(valueX);
-	tmp.push_back(valueY);
-	m_histVect[histIndex]->fill(tmp, m_currentEventWeight );
+	double values[2] = { valueX, valueY };
+	if( m_recording ) recordFill( histIndex, values, 2, 1 );
+	m_histVect[histIndex]->fillValues( values, m_currentEventWeight );
 }
 
 void
 PlotGenerator::fillHistogram( int histIndex, vector <double> &data, double weight){
+  if( m_recording ) recordFill( histIndex, data.data(), data.size(), weight );
   m_histVect[histIndex]->fill(data, m_currentEventWeight*weight );
 }
 
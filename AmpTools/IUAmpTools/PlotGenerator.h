@@ -104,6 +104,13 @@ public:
   
   void setWeightMCByIntensity( bool value );
   
+  // by default the values that projectEvent passes to fillHistogram for
+  // the MC are recorded the first time the projections are made, and new
+  // amplitude configurations refill the histograms from this record with
+  // new weights rather than calling projectEvent again -- this requires
+  // that projectEvent does not depend on getEventWeight
+  void setCacheProjections( bool value ) { m_cacheProjections = value; }
+  
   bool isReactionEnabled( const string& reactName ) const;
   bool isAmpEnabled( unsigned int uniqueAmpIndex ) const;
   bool isSumEnabled( unsigned int uniqueSumIndex ) const;
@@ -141,8 +148,26 @@ private:
   // the user may customize the behavior
   virtual void projectEvent( Kinematics* kin, const string& reaction );
   
+  // the calls to fillHistogram made by projectEvent for one data set,
+  // stored by column:  the event, histogram index, position of the first
+  // value, and extra weight of each call, with the values stored
+  // consecutively
+  struct ProjectionRecord {
+    
+    vector< double > eventWeight;
+    vector< unsigned int > fillEvent;
+    vector< unsigned int > fillHist;
+    vector< unsigned long long > fillStart;
+    vector< double > fillWeight;
+    vector< double > values;
+  };
+  
   void clearHistograms();
   void fillProjections( const string& reactName, unsigned int type );
+  void refillProjections( const ProjectionRecord& record, unsigned int dataIndex,
+                          bool weightByIntensity );
+  void recordFill( int index, const double* values, unsigned int nValues,
+                   double weight );
   
   void recordConfiguration();
   void buildUniqueAmplitudes();
@@ -201,6 +226,11 @@ private:
   
   string m_currentConfiguration;
   
+  bool m_cacheProjections;
+  map< unsigned int, ProjectionRecord > m_projectionRecords;
+  ProjectionRecord* m_recording;
+  unsigned int m_recordingEvent;
+  
   static const char* kModule;
 };
 
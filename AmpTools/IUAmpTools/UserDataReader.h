@@ -65,7 +65,7 @@ public:
    * This is the default constructor.  It should be called in the default
    * constructor of the user's derived class.
    */
-        UserDataReader< T >() : DataReader() { }
+        UserDataReader< T >() : DataReader(), m_factoryInstances( NULL ) { }
 
 
   /**
@@ -73,13 +73,20 @@ public:
    * be a corresponding constructor in the user's derived class that calls
    * this constructor.
    */
-        UserDataReader< T >( const vector< string >& args ) : DataReader( args ) { }
+        UserDataReader< T >( const vector< string >& args ) :
+        DataReader( args ), m_factoryInstances( NULL ) { }
 
 
   /**
-   * This is the destructor.
+   * This is the destructor.  An instance that was created by newDataReader
+   * removes itself from the instances held by the object that created it,
+   * so that a later request with the same arguments creates a new one.
    */
-        virtual ~UserDataReader< T >() { }
+        virtual ~UserDataReader< T >() {
+
+          if( m_factoryInstances != NULL )
+            m_factoryInstances->erase( m_factoryKey );
+        }
 
 
   /**
@@ -96,6 +103,9 @@ public:
 	      m_dataReaderInstances.end() ){
 
 	    m_dataReaderInstances[ident] = newReader;
+	    static_cast< UserDataReader< T >* >( newReader )->m_factoryInstances =
+	      &m_dataReaderInstances;
+	    static_cast< UserDataReader< T >* >( newReader )->m_factoryKey = ident;
 	  }
 	  else{
 		  
@@ -117,6 +127,10 @@ private:
   
   mutable map< string, T* > m_dataReaderInstances;
   
+  // set for the instances that were created by newDataReader
+  map< string, T* >* m_factoryInstances;
+  string m_factoryKey;
+  
 };
 
 #endif
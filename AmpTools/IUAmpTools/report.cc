@@ -42,6 +42,7 @@
 #include <cstdlib>
 #include <iomanip>
 #include <string.h>
+#include <mutex>
 
 #ifdef USE_MPI
 #include <mpi.h>
@@ -83,6 +84,10 @@ ostream& report( ReportLevel level,
 
   static string lastModule( "" ) ;
   
+  // data may be loaded by several threads at once
+  static mutex lastModuleMutex;
+  lock_guard< mutex > lock( lastModuleMutex );
+  
   if( module != lastModule && level >= currentLevel ) {
     
     report( level ) << endl << "[ " << module;
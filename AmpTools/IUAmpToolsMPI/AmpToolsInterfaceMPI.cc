@@ -1,5 +1,6 @@
 #include <mpi.h>
 #include <pthread.h>
+#include <cassert>
 
 #include "IUAmpTools/AmpToolsInterface.h"
 #include "MinuitInterface/MinuitMinimizationManager.h"
@@ -14,14 +15,23 @@
 #include "IUAmpToolsMPI/LikelihoodCalculatorMPI.h"
 #include "IUAmpToolsMPI/NormIntInterfaceMPI.h"
 #include "IUAmpToolsMPI/AmpToolsInterfaceMPI.h"
+#include "IUAmpToolsMPI/MinuitMinimizationManagerMPI.h"
+#include "IUAmpToolsMPI/RankGroupMPI.h"
+#include "IUAmpToolsMPI/SharedMemoryMPI.h"
 
 #include "IUAmpTools/report.h"
 const char* AmpToolsInterfaceMPI::kModule = "AmpToolsInterfaceMPI";
 
 AmpToolsInterfaceMPI::AmpToolsInterfaceMPI(ConfigurationInfo* configurationInfo){
 
-  MPI_Comm_rank( MPI_COMM_WORLD, &m_rank );
-  MPI_Comm_size( MPI_COMM_WORLD, &m_numProc );
+  // divide the processes into groups, if requested -- from here on
+  // the rank is the rank within the group and each group leader
+  // behaves as the leader of an independent job
+  RankGroupMPI::setup();
+  SharedMemoryMPI::setup();
+  
+  MPI_Comm_rank( RankGroupMPI::comm(), &m_rank );
+  MPI_Comm_size( RankGroupMPI::comm(), &m_numProc );
 
   m_configurationInfo = configurationInfo;
 
@@ -29,7 +39,7 @@ AmpToolsInterfaceMPI::AmpToolsInterfaceMPI(ConfigurationInfo* configurationInfo)
     // create a MinuitMinimizationManager
     // ************************
 
-  m_minuitMinimizationManager = new MinuitMinimizationManager(500);
+  m_minuitMinimizationManager = new MinuitMinimizationManagerMPI(500);
 
     // ************************
     // create an AmplitudeManager for each reaction
@@ -164,6 +174,16 @@ AmpToolsInterfaceMPI::AmpToolsInterfaceMPI(ConfigurationInfo* configurationInfo)
                                  m_minuitMinimizationManager,
                                  m_parameterManager );
 
+  if (m_rank == 0 && RankGroupMPI::group() != 0){
+    
+    // leaders of the other groups evaluate the likelihood at the
+    // parameter values sent by the leader of the first group until
+    // the fit is done -- their followers are released when the
+    // caller invokes exitMPI()
+    dynamic_cast< MinuitMinimizationManagerMPI* >( m_minuitMinimizationManager )
+      ->serveEvaluations();
+  }
+  
   if (m_rank != 0){
     
     // the followers should be ready to fit and finalize the fit in successsion
@@ -184,6 +204,10 @@ void AmpToolsInterfaceMPI::exitMPI(){
   
   if (m_rank == 0){
 
+    // release the leaders of the other groups, if there are any
+    dynamic_cast< MinuitMinimizationManagerMPI* >( m_minuitMinimizationManager )
+      ->stopServers();
+    
     for (unsigned int irct = 0;
          irct < m_configurationInfo->reactionList().size(); irct++){
       ReactionInfo* reaction = m_configurationInfo->reactionList()[irct];
@@ -193,6 +217,18 @@ void AmpToolsInterfaceMPI::exitMPI(){
       m_likCalcMap.erase(reactionName);
     }
   }
+  
+  // the shared memory windows are freed collectively by processes with
+  // identical data -- the four-vectors must not be used after this
+  SharedMemoryMPI::freeWindows();
+}
+
+void
+AmpToolsInterfaceMPI::setBootstrapReplica( unsigned long long seed,
+                                           unsigned long long replica ){
+  
+  report( ERROR, kModule ) << "bootstrap resampling is not supported with MPI" << endl;
+  assert( false );
 }
 
 void
@@ -2,6 +2,8 @@
 #define AMPTOOLSINTERFACEMPI
 
 #include "IUAmpTools/AmpToolsInterface.h"
+#include "IUAmpToolsMPI/RankGroupMPI.h"
+#include "IUAmpToolsMPI/SharedMemoryMPI.h"
 
 using namespace std;
 
@@ -12,9 +14,25 @@ public:
   AmpToolsInterfaceMPI(ConfigurationInfo* cfgInfo);
   ~AmpToolsInterfaceMPI(){}
   
+  // divide the processes into the specified number of groups that
+  // evaluate the likelihood at different parameter values at the same
+  // time -- must be called on all processes prior to construction
+  static void setNumGroups( int numGroups ) {
+    RankGroupMPI::setNumGroups( numGroups ); }
+  
+  // keep one copy of the Monte Carlo four-vectors per node for processes
+  // that hold identical data, which happens when there is more than one
+  // group -- must be called on all processes prior to construction
+  static void setUseSharedMemory( bool useShared ) {
+    SharedMemoryMPI::setUseSharedMemory( useShared ); }
+  
   void finalizeFit( const string& tag = "" );
+  
+  // bootstrap resampling is not supported since the data are divided
+  // among the followers -- this reports an error and aborts
+  void setBootstrapReplica( unsigned long long seed, unsigned long long replica );
 
-  // exit MPI should be called on the leader process before
+  // exit MPI should be called on all processes before
   // MPI_Finalize() or variables go out of scope
   void exitMPI();
   
@@ -1,10 +1,15 @@
 #ifndef DATAREADERMPI
 #define DATAREADERMPI
 
+#include <sstream>
+#include <cassert>
+
 #include "mpi.h"
 
 #include "IUAmpTools/Kinematics.h"
+#include "IUAmpTools/AmpVecs.h"
 #include "IUAmpToolsMPI/MPITag.h"
+#include "IUAmpToolsMPI/RankGroupMPI.h"
 
 #include "IUAmpTools/report.h"
 static const char* kDRModule = "DataReaderMPI";
@@ -69,6 +74,10 @@ public:
   
   unsigned int numEvents() const;
 
+  // only the leader reads from the source, the followers provide
+  // the events that were sent to them through getEvent
+  bool hasBulkRead() const { return m_isLeader && T::hasBulkRead(); }
+  
   /**
    * This method can create a new data reader (of the derived type).
    */
@@ -113,6 +122,16 @@ public:
    */
   virtual bool isDefault() const { return ( m_isDefault == true ); }
 
+  /**
+   * The followers only hold a slice of the data so the rank and the
+   * number of processes become part of the identifier of the cache.
+   * If every follower finds its slice in the cache when the data reader
+   * is created then the leader does not read or distribute the source.
+   * The cache directory must then be the same on all processes.
+   *
+   * \see AmpVecs::setCacheDirectory
+   */
+  virtual string cacheIdentifier() const;
   
 private:
 
@@ -123,6 +142,7 @@ private:
   
   void defineMPIType();
   void provideData();
+  bool sliceCached();
   void distributeData();
   void receiveData();
   
@@ -150,11 +170,12 @@ DataReaderMPI<T>::DataReaderMPI( const vector< string >& args ) :
   m_isDefault(false),
   m_args(args),
   m_ptrCache( 0 ),
-  m_ptrItr( m_ptrCache.begin() )
+  m_ptrItr( m_ptrCache.begin() ),
+  m_numEvents( 0 )
 {
    
-  MPI_Comm_rank( MPI_COMM_WORLD, &m_rank );
-  MPI_Comm_size( MPI_COMM_WORLD, &m_numProc );
+  MPI_Comm_rank( RankGroupMPI::comm(), &m_rank );
+  MPI_Comm_size( RankGroupMPI::comm(), &m_numProc );
   
   m_isLeader = ( m_rank == 0 );
   
@@ -187,6 +208,13 @@ Kinematics* DataReaderMPI<T>::getEvent()
   
   if( m_isLeader ) return T::getEvent();
   
+  if( m_ptrCache.empty() && m_numEvents > 0 ){
+    
+    report( ERROR, kDRModule ) << "Process " << m_rank
+    << " expected to find its events in the cache." << endl;
+    assert( false );
+  }
+  
   if( m_ptrItr != m_ptrCache.end() ){
     
     // the standard behavior for DataReaders is that the calling class
@@ -229,13 +257,61 @@ void DataReaderMPI<T>::resetSource()
   }
 }
 
+template< class T >
+string DataReaderMPI<T>::cacheIdentifier() const
+{
+  if( m_isLeader ) return T::cacheIdentifier();
+  
+  ostringstream id;
+  id << T::cacheIdentifier() << "%%MPI " << m_rank << " " << m_numProc;
+  
+  return id.str();
+}
+
 template< class T >
 void DataReaderMPI<T>::provideData()
 {
+  // the followers load their events directly from the cache
+  // when loadData is called if all of them have a copy
+  if( sliceCached() ) return;
+  
   if( m_isLeader ) distributeData();
   else receiveData();   
 }
 
+template< class T >
+bool DataReaderMPI<T>::sliceCached()
+{
+  if( AmpVecs::cacheDirectory().empty() || m_numProc < 2 ) return false;
+  
+  int totalEvents = ( m_isLeader ? T::numEvents() : 0 );
+  MPI_Bcast( &totalEvents, 1, MPI_INT, 0, RankGroupMPI::comm() );
+  
+  int cached = 1;
+  
+  if( !m_isLeader ){
+    
+    // this is the same division of the events as in distributeData
+    int stepSize = totalEvents / ( m_numProc - 1 );
+    int remainder = totalEvents % ( m_numProc - 1 );
+    m_numEvents = ( m_rank > remainder ? stepSize : stepSize + 1 );
+    
+    if( m_numEvents > 0 && !AmpVecs::hasValidCache( this ) ) cached = 0;
+  }
+  
+  int allCached;
+  MPI_Allreduce( &cached, &allCached, 1, MPI_INT, MPI_MIN,
+                 RankGroupMPI::comm() );
+  
+  if( allCached ){
+    
+    report( DEBUG, kDRModule ) << "Process " << m_rank
+    << " will load its events from the cache." << endl;
+  }
+  
+  return ( allCached == 1 );
+}
+
 template< class T >
 void DataReaderMPI<T>::distributeData()
 {
@@ -258,7 +334,7 @@ void DataReaderMPI<T>::distributeData()
     
     report( DEBUG, kDRModule ) << "Sending process " << i << " " << nEvents << " events" << endl;
     
-    MPI_Send( &nEvents, 1, MPI_INT, i, MPITag::kIntSend, MPI_COMM_WORLD );
+    MPI_Send( &nEvents, 1, MPI_INT, i, MPITag::kIntSend, RankGroupMPI::comm() );
     for( int j = 0; j < nEvents; ++j ){
       
       Kinematics* event = T::getEvent();
@@ -270,14 +346,14 @@ void DataReaderMPI<T>::distributeData()
     }
     
     MPI_Send( kinArray, nEvents, MPI_KinStruct, i, MPITag::kDataSend,
-              MPI_COMM_WORLD );
+              RankGroupMPI::comm() );
     
     report( DEBUG, kDRModule ) << "Waiting for acknowledge from " << i << endl;
     flush( cout );
     
     // wait for acknowledgment before continuing
     MPI_Recv( &nEvents, 1, MPI_INT, i, MPITag::kAcknowledge, 
-             MPI_COMM_WORLD, &status );
+             RankGroupMPI::comm(), &status );
     
     report( DEBUG, kDRModule ) << "Send to process " << i << " finished." << endl;
     flush( cout );
@@ -295,7 +371,7 @@ void DataReaderMPI<T>::receiveData()
   MPI_Status status;
   
   MPI_Recv( &nEvents, 1, MPI_INT, 0, MPITag::kIntSend, 
-           MPI_COMM_WORLD, &status );
+           RankGroupMPI::comm(), &status );
   
   report( DEBUG, kDRModule ) << "Process " << m_rank << " waiting for "
   << nEvents << " events." << endl;
@@ -303,7 +379,7 @@ void DataReaderMPI<T>::receiveData()
   KinStruct* kinArray = new KinStruct[nEvents];
   
   MPI_Recv( kinArray, nEvents, MPI_KinStruct, 0, MPITag::kDataSend,
-            MPI_COMM_WORLD, &status );
+            RankGroupMPI::comm(), &status );
   
   for( int i = 0; i < nEvents; ++i ){
     
@@ -318,7 +394,7 @@ void DataReaderMPI<T>::receiveData()
   m_numEvents = static_cast< unsigned int >( m_ptrCache.size() );
   
   // send acknowledgment
-  MPI_Send( &nEvents, 1, MPI_INT, 0, MPITag::kAcknowledge, MPI_COMM_WORLD );
+  MPI_Send( &nEvents, 1, MPI_INT, 0, MPITag::kAcknowledge, RankGroupMPI::comm() );
   
   delete[] kinArray;
 }
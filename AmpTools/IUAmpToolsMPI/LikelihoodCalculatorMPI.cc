@@ -39,6 +39,7 @@
 
 #include "IUAmpToolsMPI/LikelihoodCalculatorMPI.h"
 #include "IUAmpToolsMPI/LikelihoodManagerMPI.h"
+#include "IUAmpToolsMPI/RankGroupMPI.h"
 
 #include "IUAmpTools/report.h"
 const char* LikelihoodCalculatorMPI::kModule = "LikelihoodCalculatorMPI";
@@ -62,7 +63,7 @@ m_firstPass( true )
   if( !m_isLeader ){
     
     // check back in with the leader after registration
-    MPI_Send( &m_thisId, 1, MPI_INT, 0, MPITag::kIntSend, MPI_COMM_WORLD );
+    MPI_Send( &m_thisId, 1, MPI_INT, 0, MPITag::kIntSend, RankGroupMPI::comm() );
   }
   else{
     
@@ -75,7 +76,7 @@ m_firstPass( true )
     
     for( int i = 1; i < m_numProc; ++i ){
       
-      MPI_Recv( &id, 1, MPI_INT, i, MPITag::kIntSend, MPI_COMM_WORLD, &status );
+      MPI_Recv( &id, 1, MPI_INT, i, MPITag::kIntSend, RankGroupMPI::comm(), &status );
       
       // ids should match
       assert( m_thisId == id );
@@ -99,7 +100,7 @@ LikelihoodCalculatorMPI::~LikelihoodCalculatorMPI(){
     
     // break the likelihood manager out of its loop on the followers
     cmnd[1] = LikelihoodManagerMPI::kExit;
-    MPI_Bcast( cmnd, 2, MPI_INT, 0, MPI_COMM_WORLD );
+    MPI_Bcast( cmnd, 2, MPI_INT, 0, RankGroupMPI::comm() );
   }
 }
 
@@ -123,7 +124,7 @@ LikelihoodCalculatorMPI::finalizeFit(){
     
     // break the likelihood manager out of its loop on the followers
     cmnd[1] = LikelihoodManagerMPI::kFinalizeFit;
-    MPI_Bcast( cmnd, 2, MPI_INT, 0, MPI_COMM_WORLD );
+    MPI_Bcast( cmnd, 2, MPI_INT, 0, RankGroupMPI::comm() );
   }
 }
 
@@ -145,14 +146,22 @@ LikelihoodCalculatorMPI::operator()()
   // likelihood calculator share the same parameter manager -- this
   // cause a little extra overhead in multiple final-state fits
   cmnd[1] = LikelihoodManagerMPI::kUpdateParameters;
-  MPI_Bcast( cmnd, 2, MPI_INT, 0, MPI_COMM_WORLD );
+  MPI_Bcast( cmnd, 2, MPI_INT, 0, RankGroupMPI::comm() );
   
   // tell the leader to do parameter update
   m_parManager.updateParameters();
   
+  // if we have an amplitude with a free parameter, the call to normIntTerm()
+  // will trigger recomputation of NI's -- in this case the followers compute
+  // the NI's right after their partial sums without waiting for another
+  // command from the leader
+  bool computeIntegrals = m_intenManager.hasTermWithFreeParam() || m_firstPass;
+  
   // tell all of the followers to send the partial sums
-  cmnd[1] = LikelihoodManagerMPI::kComputeLikelihood;
-  MPI_Bcast( cmnd, 2, MPI_INT, 0, MPI_COMM_WORLD );
+  cmnd[1] = ( computeIntegrals ?
+              LikelihoodManagerMPI::kComputeLikelihoodAndIntegrals :
+              LikelihoodManagerMPI::kComputeLikelihood );
+  MPI_Bcast( cmnd, 2, MPI_INT, 0, RankGroupMPI::comm() );
   
   double lnL = 0;
   double sumBkgWeights = 0;
@@ -161,17 +170,37 @@ LikelihoodCalculatorMPI::operator()()
   double numDataEvents = 0;
   double data[5]; 
  
-  // collect the sums
-  for( int i = 1; i < m_numProc; ++i ){
+  if( computeIntegrals ){
     
-    MPI_Recv( (double*)&data, 5, MPI_DOUBLE, i, MPITag::kDoubleSend,
-             MPI_COMM_WORLD, &status );
+    // the followers contribute to this reduction and then go on to the
+    // NI computation -- the leader contributes zeroes
+    double zero[5] = { 0, 0, 0, 0, 0 };
+    MPI_Request request;
     
-    lnL           += data[0];
-    sumBkgWeights += data[1];
-    numBkgEvents  += data[2];
-    sumDataWeights+= data[3];
-    numDataEvents += data[4];
+    MPI_Ireduce( zero, data, 5, MPI_DOUBLE, MPI_SUM, 0,
+                 RankGroupMPI::comm(), &request );
+    MPI_Wait( &request, &status );
+    
+    lnL            = data[0];
+    sumBkgWeights  = data[1];
+    numBkgEvents   = data[2];
+    sumDataWeights = data[3];
+    numDataEvents  = data[4];
+  }
+  else{
+    
+    // collect the sums
+    for( int i = 1; i < m_numProc; ++i ){
+      
+      MPI_Recv( (double*)&data, 5, MPI_DOUBLE, i, MPITag::kDoubleSend,
+               RankGroupMPI::comm(), &status );
+      
+      lnL           += data[0];
+      sumBkgWeights += data[1];
+      numBkgEvents  += data[2];
+      sumDataWeights+= data[3];
+      numDataEvents += data[4];
+    }
   }
 
 #ifndef USE_LEGACY_LN_LIK_SCALING
@@ -196,15 +225,6 @@ LikelihoodCalculatorMPI::operator()()
     assert( false );
   }
   
-  // if we have an amplitude with a free parameter, the call to normIntTerm()
-  // will trigger recomputation of NI's -- we need to put the followers in the
-  // loop to send the recomputed NI's back to the leader
-  if( m_intenManager.hasTermWithFreeParam() || m_firstPass ){
-    
-    cmnd[1] = LikelihoodManagerMPI::kComputeIntegrals;
-    MPI_Bcast( cmnd, 2, MPI_INT, 0, MPI_COMM_WORLD );
-  }
-  
   // this call will utilize the NormIntInterface on the leader which
   // ultimately gets handled by the instance of NormIntInterfaceMPI
   // that is passed into the constructor of this class
@@ -258,7 +278,36 @@ LikelihoodCalculatorMPI::computeLikelihood()
   assert( !m_isLeader );
   
   double data[5];
+  fillPartialSums( data );
+
+  MPI_Send( (double*)&data, 5, MPI_DOUBLE, 0, MPITag::kDoubleSend, RankGroupMPI::comm() );
+}
+
+void
+LikelihoodCalculatorMPI::computeLikelihoodAndIntegrals()
+{
+  assert( !m_isLeader );
+  
+  double data[5];
+  fillPartialSums( data );
+  
+  // start the reduction of the partial sums and compute the NI's while
+  // it is in progress -- the NI's are summed over processes inside of
+  // normIntTerm() by NormIntInterfaceMPI, which is also what the leader
+  // does after the reduction of the partial sums completes
+  MPI_Request request;
+  MPI_Ireduce( data, NULL, 5, MPI_DOUBLE, MPI_SUM, 0,
+               RankGroupMPI::comm(), &request );
   
+  normIntTerm();
+  
+  MPI_Status status;
+  MPI_Wait( &request, &status );
+}
+
+void
+LikelihoodCalculatorMPI::fillPartialSums( double* data )
+{
   // true flag will suppress error checking on the
   // sum of background weights on each node -- this checking
   // happpens on the leader node in operator()() above
@@ -272,15 +321,13 @@ LikelihoodCalculatorMPI::computeLikelihood()
   data[0] += data[3]*log(data[4]);
   if(data[2] != 0) data[0] -= data[1]*log(data[2]);
 #endif 
-
-  MPI_Send( (double*)&data, 5, MPI_DOUBLE, 0, MPITag::kDoubleSend, MPI_COMM_WORLD );
 }
 
 void
 LikelihoodCalculatorMPI::setupMPI()
 {
-  MPI_Comm_rank( MPI_COMM_WORLD, &m_rank );
-  MPI_Comm_size( MPI_COMM_WORLD, &m_numProc );
+  MPI_Comm_rank( RankGroupMPI::comm(), &m_rank );
+  MPI_Comm_size( RankGroupMPI::comm(), &m_numProc );
   
   m_isLeader = ( m_rank == 0 );
 }
@@ -117,9 +117,11 @@ public:
    * Using the LikelihoodManagerMPI, it directs all of the followers to compute
    * and then send partial contributions of the sum of log intensities.  The
    * routine on the leader collects and sums the contributions from the followers.
-   * It then, if necessary, triggers an update of the normalization integral
-   * calculculation on the followers.  Finally it provides the new
-   * -2 ln( likelihood ) for the fit.
+   * If the normalization integrals need to be updated, the followers are
+   * directed to compute them immediately after the partial sums with a
+   * single command, and the partial sums are collected with a nonblocking
+   * reduction that is completed after the integrals have been computed.
+   * Finally it provides the new -2 ln( likelihood ) for the fit.
    */
   double operator()();
   
@@ -146,6 +148,10 @@ private:
   void updateParameters();
   void updateAmpParameter();
   void computeLikelihood();
+  void computeLikelihoodAndIntegrals();
+  
+  // fills the five partial sums that followers contribute to the likelihood
+  void fillPartialSums( double* data );
   
   static int m_idCounter;
   
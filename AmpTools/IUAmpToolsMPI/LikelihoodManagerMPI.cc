@@ -42,6 +42,7 @@
 #include "IUAmpToolsMPI/LikelihoodManagerMPI.h"
 #include "IUAmpToolsMPI/LikelihoodCalculatorMPI.h"
 #include "IUAmpToolsMPI/MPITag.h"
+#include "IUAmpToolsMPI/RankGroupMPI.h"
 
 #include "IUAmpTools/report.h"
 const char* LikelihoodManagerMPI::kModule = "LikelihoodManagerMPI";
@@ -74,7 +75,7 @@ LikelihoodManagerMPI::deliverLikelihood()
   LikelihoodCalculatorMPI* likCalc;
   map< int, LikelihoodCalculatorMPI* >::iterator mapItr;
   
-  MPI_Bcast( cmnd, 2, MPI_INT, 0, MPI_COMM_WORLD );
+  MPI_Bcast( cmnd, 2, MPI_INT, 0, RankGroupMPI::comm() );
   
   while( ( *fitFlag != kExit ) && ( *fitFlag != kFinalizeFit ) ){
     
@@ -107,13 +108,18 @@ LikelihoodManagerMPI::deliverLikelihood()
         likCalc->computeLikelihood();
         break;
         
+      case kComputeLikelihoodAndIntegrals:
+        
+        likCalc->computeLikelihoodAndIntegrals();
+        break;
+        
       default:
         
         report( ERROR, kModule ) << "Unknown command flag!" << endl;
         assert( false );
     }
     
-    MPI_Bcast( cmnd, 2, MPI_INT, 0, MPI_COMM_WORLD );
+    MPI_Bcast( cmnd, 2, MPI_INT, 0, RankGroupMPI::comm() );
   }
 
   m_lastCommand = static_cast<LikelihoodManagerMPI::FitCommand>(*fitFlag);
@@ -145,16 +151,16 @@ LikelihoodManagerMPI::broadcastToFirst( FitCommand command ){
   cmnd[0] = mapItr->first;    
    
   // this will send a command to just the first registered calculator
-  MPI_Bcast( cmnd, 2, MPI_INT, 0, MPI_COMM_WORLD );
+  MPI_Bcast( cmnd, 2, MPI_INT, 0, RankGroupMPI::comm() );
 }
 
 void
 LikelihoodManagerMPI::setupMPI()
 {
   int rank;
-  MPI_Comm_rank( MPI_COMM_WORLD, &rank );
+  MPI_Comm_rank( RankGroupMPI::comm(), &rank );
   m_isLeader = ( rank == 0 );
-  MPI_Comm_size( MPI_COMM_WORLD, &m_numProc );
+  MPI_Comm_size( RankGroupMPI::comm(), &m_numProc );
   m_mpiSetup = true;
 }
 
@@ -58,6 +58,7 @@ class LikelihoodManagerMPI
 
   enum FitCommand { kComputeLikelihood,
                     kComputeIntegrals,
+                    kComputeLikelihoodAndIntegrals,
                     kUpdateParameters,
                     kUpdateAmpParameter,
                     kFinalizeFit,
@@ -0,0 +1,147 @@
+
+//******************************************************************************
+// This file is part of AmpTools, a package for performing Amplitude Analysis
+//
+// Copyright Trustees of Indiana University 2010, all rights reserved
+//
+// This software written by Matthew Shepherd, Ryan Mitchell, and
+//                  Hrayr Matevosyan at Indiana University, Bloomington
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice and author attribution, this list of conditions and the
+//    following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice and author attribution, this list of conditions and the
+//    following disclaimer in the documentation and/or other materials
+//    provided with the distribution.
+// 3. Neither the name of the University nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// Creation of derivative forms of this software for commercial
+// utilization may be subject to restriction; written permission may be
+// obtained from the Trustees of Indiana University.
+//
+// INDIANA UNIVERSITY AND THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES,
+// EXPRESS OR IMPLIED.  By way of example, but not limitation, INDIANA
+// UNIVERSITY MAKES NO REPRESENTATIONS OR WARRANTIES OF MERCANTABILITY OR
+// FITNESS FOR ANY PARTICULAR PURPOSE OR THAT THE USE OF THIS SOFTWARE OR
+// DOCUMENTATION WILL NOT INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS,
+// OR OTHER RIGHTS.  Neither Indiana University nor the authors shall be
+// held liable for any liability with respect to any claim by the user or
+// any other party arising from use of the program.
+//******************************************************************************
+
+#include <cassert>
+#include <mpi.h>
+
+#include "IUAmpToolsMPI/MinuitMinimizationManagerMPI.h"
+#include "IUAmpToolsMPI/RankGroupMPI.h"
+#include "IUAmpToolsMPI/MPITag.h"
+
+#include "IUAmpTools/report.h"
+const char* MinuitMinimizationManagerMPI::kModule = "MinuitMinimizationManagerMPI";
+
+MinuitMinimizationManagerMPI::MinuitMinimizationManagerMPI( int maxParameters ) :
+MinuitMinimizationManager( maxParameters )
+{}
+
+int
+MinuitMinimizationManagerMPI::maxConcurrentEvaluations() const {
+  
+  return RankGroupMPI::numGroups();
+}
+
+void
+MinuitMinimizationManagerMPI::evaluateBatch( const vector< vector< double > >& parList,
+                                             vector< double >& fvalList,
+                                             int flag ){
+  
+  // this should only be called on the leader of the first group
+  assert( RankGroupMPI::group() == 0 );
+  
+  MPI_Comm leaders = RankGroupMPI::leaderComm();
+  int numGroups = RankGroupMPI::numGroups();
+  
+  MPI_Status status;
+  
+  fvalList.resize( parList.size() );
+  
+  for( unsigned int first = 0; first < parList.size(); first += numGroups ){
+    
+    unsigned int nThis = parList.size() - first;
+    if( nThis > (unsigned int)numGroups ) nThis = numGroups;
+    
+    // send the parameters to the other groups
+    for( unsigned int g = 1; g < nThis; ++g ){
+      
+      int cmnd = RankGroupMPI::kEvaluate;
+      int nPar = parList[first+g].size();
+      
+      MPI_Send( &cmnd, 1, MPI_INT, g, MPITag::kIntSend, leaders );
+      MPI_Send( &nPar, 1, MPI_INT, g, MPITag::kIntSend, leaders );
+      MPI_Send( const_cast< double* >( &(parList[first+g][0]) ), nPar,
+                MPI_DOUBLE, g, MPITag::kDoubleSend, leaders );
+    }
+    
+    // evaluate the first point here while the others are working --
+    // use operator() as MINUIT would so that the flag is handled
+    // in the same way as it is for a single evaluation
+    int npar = parList[first].size();
+    minuitMinimizer().SetParameterList( parList[first] );
+    (*this)( npar, NULL, fvalList[first], parList[first], flag );
+    
+    // collect the results
+    for( unsigned int g = 1; g < nThis; ++g ){
+      
+      MPI_Recv( &(fvalList[first+g]), 1, MPI_DOUBLE, g, MPITag::kDoubleSend,
+                leaders, &status );
+    }
+  }
+}
+
+void
+MinuitMinimizationManagerMPI::serveEvaluations(){
+  
+  assert( RankGroupMPI::group() != 0 );
+  
+  MPI_Comm leaders = RankGroupMPI::leaderComm();
+  MPI_Status status;
+  
+  vector< double > par;
+  int cmnd, nPar;
+  
+  report( DEBUG, kModule ) << "Leader of group " << RankGroupMPI::group()
+  << " waiting for parameters." << endl;
+  
+  MPI_Recv( &cmnd, 1, MPI_INT, 0, MPITag::kIntSend, leaders, &status );
+  
+  while( cmnd == RankGroupMPI::kEvaluate ){
+    
+    MPI_Recv( &nPar, 1, MPI_INT, 0, MPITag::kIntSend, leaders, &status );
+    par.resize( nPar );
+    MPI_Recv( &(par[0]), nPar, MPI_DOUBLE, 0, MPITag::kDoubleSend, leaders,
+              &status );
+    
+    double fval = evaluateFunction( par );
+    
+    MPI_Send( &fval, 1, MPI_DOUBLE, 0, MPITag::kDoubleSend, leaders );
+    
+    MPI_Recv( &cmnd, 1, MPI_INT, 0, MPITag::kIntSend, leaders, &status );
+  }
+}
+
+void
+MinuitMinimizationManagerMPI::stopServers(){
+  
+  if( RankGroupMPI::numGroups() <= 1 || RankGroupMPI::group() != 0 ) return;
+  
+  int cmnd = RankGroupMPI::kExit;
+  for( int g = 1; g < RankGroupMPI::numGroups(); ++g ){
+    
+    MPI_Send( &cmnd, 1, MPI_INT, g, MPITag::kIntSend, RankGroupMPI::leaderComm() );
+  }
+}
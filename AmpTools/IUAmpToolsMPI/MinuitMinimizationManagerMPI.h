@@ -0,0 +1,82 @@
+#if !defined(MINUITMINIMIZATIONMANAGERMPI)
+#define MINUITMINIMIZATIONMANAGERMPI
+
+
+//******************************************************************************
+// This file is part of AmpTools, a package for performing Amplitude Analysis
+//
+// Copyright Trustees of Indiana University 2010, all rights reserved
+//
+// This software written by Matthew Shepherd, Ryan Mitchell, and
+//                  Hrayr Matevosyan at Indiana University, Bloomington
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice and author attribution, this list of conditions and the
+//    following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice and author attribution, this list of conditions and the
+//    following disclaimer in the documentation and/or other materials
+//    provided with the distribution.
+// 3. Neither the name of the University nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// Creation of derivative forms of this software for commercial
+// utilization may be subject to restriction; written permission may be
+// obtained from the Trustees of Indiana University.
+//
+// INDIANA UNIVERSITY AND THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES,
+// EXPRESS OR IMPLIED.  By way of example, but not limitation, INDIANA
+// UNIVERSITY MAKES NO REPRESENTATIONS OR WARRANTIES OF MERCANTABILITY OR
+// FITNESS FOR ANY PARTICULAR PURPOSE OR THAT THE USE OF THIS SOFTWARE OR
+// DOCUMENTATION WILL NOT INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS,
+// OR OTHER RIGHTS.  Neither Indiana University nor the authors shall be
+// held liable for any liability with respect to any claim by the user or
+// any other party arising from use of the program.
+//******************************************************************************
+
+#include <vector>
+
+#include "MinuitInterface/MinuitMinimizationManager.h"
+
+using namespace std;
+
+/**
+ * This class extends the MinuitMinimizationManager so that independent
+ * evaluations of the function requested by MINUIT are distributed over
+ * the groups of processes set up by RankGroupMPI.  On the leader of the
+ * first group it is used for the minimization.  On the leaders of the
+ * other groups serveEvaluations() waits for parameter values, evaluates
+ * the function, and returns the result.
+ *
+ * \ingroup IUAmpToolsMPI
+ */
+
+class MinuitMinimizationManagerMPI : public MinuitMinimizationManager
+{
+  
+public:
+  
+  MinuitMinimizationManagerMPI( int maxParameters = 50 );
+  
+  // from URFcn:  the number of groups that can evaluate simultaneously
+  int maxConcurrentEvaluations() const;
+  void evaluateBatch( const vector< vector< double > >& parList,
+                      vector< double >& fvalList, int flag );
+  
+  // called on the leaders of groups other than the first, this returns
+  // when the leader of the first group calls stopServers()
+  void serveEvaluations();
+  
+  // called on the leader of the first group to release the other leaders
+  void stopServers();
+  
+private:
+  
+  static const char* kModule;
+};
+
+#endif
@@ -43,19 +43,29 @@
 
 #include "IUAmpToolsMPI/NormIntInterfaceMPI.h"
 #include "IUAmpToolsMPI/MPITag.h"
+#include "IUAmpToolsMPI/RankGroupMPI.h"
+#include "IUAmpToolsMPI/SharedMemoryMPI.h"
 
 using namespace std;
 
 NormIntInterfaceMPI::NormIntInterfaceMPI( DataReader* genMCData, 
                                           DataReader* accMCData, 
                                           const IntensityManager& intenManager ):
-NormIntInterface( genMCData, accMCData, intenManager )
+NormIntInterface( genMCData, accMCData, intenManager ),
+m_totalGenEvents( 0 )
 {
-  setupMPI();  
+  setupMPI();
+  
+  // all processes are loading the accepted MC at this point so it is safe
+  // to move identical copies on a node into shared memory -- objects that
+  // use data hosted by another object are updated by the host (the
+  // generated MC is read later, and only on the followers)
+  if( !accMCVecs().m_usesSharedData ) SharedMemoryMPI::shareFourVecs( accMCVecs() );
 }
 
 NormIntInterfaceMPI::NormIntInterfaceMPI( const string& normIntFile ) :
-NormIntInterface( normIntFile )
+NormIntInterface( normIntFile ),
+m_totalGenEvents( 0 )
 {}
 
 NormIntInterfaceMPI::~NormIntInterfaceMPI() {
@@ -81,6 +91,14 @@ void NormIntInterfaceMPI::forceCacheUpdate( bool normIntOnly ) const {
   
   if( !m_isLeader ) NormIntInterface::forceCacheUpdate( normIntOnly );
   
+  // during a fit only the normalization integrals for terms with
+  // changed parameters need to be summed over processes
+  if( normIntOnly && !m_normIntSum.empty() ){
+    
+    sumChangedIntegrals();
+    return;
+  }
+  
   if( !normIntOnly ) sumIntegrals( kAmpInt );
   sumIntegrals( kNormInt );
 }
@@ -88,8 +106,8 @@ void NormIntInterfaceMPI::forceCacheUpdate( bool normIntOnly ) const {
 void
 NormIntInterfaceMPI::setupMPI()
 {
-  MPI_Comm_rank( MPI_COMM_WORLD, &m_rank );
-  MPI_Comm_size( MPI_COMM_WORLD, &m_numProc );
+  MPI_Comm_rank( RankGroupMPI::comm(), &m_rank );
+  MPI_Comm_size( RankGroupMPI::comm(), &m_numProc );
   
   MPI_Status status;
   
@@ -108,20 +126,20 @@ NormIntInterfaceMPI::setupMPI()
 
       // trigger sending of events from followers -- data is irrelevant
       MPI_Send( &thisEvents, 1, MPI_UNSIGNED_LONG, i, MPITag::kAcknowledge,
-               MPI_COMM_WORLD );
+               RankGroupMPI::comm() );
       
       // now receive actual data
       MPI_Recv( &thisEvents, 1, MPI_UNSIGNED_LONG, i, MPITag::kLongIntSend,
-               MPI_COMM_WORLD, &status );
+               RankGroupMPI::comm(), &status );
       totalGenEvents += thisEvents;
       
       MPI_Recv( &thisWeights, 1, MPI_DOUBLE, i, MPITag::kDoubleSend,
-               MPI_COMM_WORLD, &status );
+               RankGroupMPI::comm(), &status );
       totalAccWeights += thisWeights;
       
       // send acknowledgment 
       MPI_Send( &thisEvents, 1, MPI_UNSIGNED_LONG, i, MPITag::kAcknowledge,
-               MPI_COMM_WORLD );
+               RankGroupMPI::comm() );
     }
     
     setGenEvents( totalGenEvents );
@@ -140,16 +158,16 @@ NormIntInterfaceMPI::setupMPI()
     // to signal that it is ready to accept numbers of events
 
     // data is irrelevant for this receive
-    MPI_Recv( &thisEvents, 1, MPI_UNSIGNED_LONG, 0, MPITag::kAcknowledge, MPI_COMM_WORLD,
+    MPI_Recv( &thisEvents, 1, MPI_UNSIGNED_LONG, 0, MPITag::kAcknowledge, RankGroupMPI::comm(),
               &status );
 
     thisEvents = numGenEvents();
-    MPI_Send( &thisEvents, 1, MPI_UNSIGNED_LONG, 0, MPITag::kLongIntSend, MPI_COMM_WORLD );
+    MPI_Send( &thisEvents, 1, MPI_UNSIGNED_LONG, 0, MPITag::kLongIntSend, RankGroupMPI::comm() );
     
     thisWeights = numAccEvents();
-    MPI_Send( &thisWeights, 1, MPI_DOUBLE, 0, MPITag::kDoubleSend, MPI_COMM_WORLD );
+    MPI_Send( &thisWeights, 1, MPI_DOUBLE, 0, MPITag::kDoubleSend, RankGroupMPI::comm() );
     
-    MPI_Recv( &thisEvents, 1, MPI_UNSIGNED_LONG, 0, MPITag::kAcknowledge, MPI_COMM_WORLD,
+    MPI_Recv( &thisEvents, 1, MPI_UNSIGNED_LONG, 0, MPITag::kAcknowledge, RankGroupMPI::comm(),
              &status );
   }
 }
@@ -176,12 +194,13 @@ NormIntInterfaceMPI::sumIntegrals( IntType type ) const
   // and other nodes will hold integrals for their subsets of data
   
   // sum over all nodes and distribute results to each
-  MPI_Allreduce( integrals, result, cacheSize(), MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD );
+  MPI_Allreduce( integrals, result, cacheSize(), MPI_DOUBLE, MPI_SUM, RankGroupMPI::comm() );
 
   // now broadcast the total number of events from the leader to the
   // followers so that they may renormalize the sum properly
   int totalEvents = numGenEvents();
-  MPI_Bcast( &totalEvents, 1, MPI_INT, 0, MPI_COMM_WORLD );
+  MPI_Bcast( &totalEvents, 1, MPI_INT, 0, RankGroupMPI::comm() );
+  m_totalGenEvents = totalEvents;
   
   // and renormalize the sum
   for( int i = 0; i < cacheSize(); ++i ) result[i] /= totalEvents;
@@ -190,6 +209,14 @@ NormIntInterfaceMPI::sumIntegrals( IntType type ) const
   if( type == kNormInt ){
     
     setNormIntMatrix( result );
+    m_normIntSum.assign( result, result + cacheSize() );
+    
+    // record the state of the terms for the next sum of changed elements
+    m_termIteration.resize( numTerms() );
+    for( int i = 0; i < numTerms(); ++i ){
+      
+      m_termIteration[i] = intenManager()->termIteration( i );
+    }
   }
   else{
     
@@ -198,3 +225,82 @@ NormIntInterfaceMPI::sumIntegrals( IntType type ) const
   
   delete[] result;
 }
+
+void
+NormIntInterfaceMPI::sumChangedIntegrals() const
+{
+  // This is an optimized version of sumIntegrals( kNormInt ) for use
+  // during a fit.  Typically only a few terms have free parameters and
+  // only the rows and columns of the NI matrix for those terms change
+  // between iterations.  Every process receives the same parameter
+  // updates, so every process can tell which terms changed since the
+  // last sum without any communication, and only the elements in the
+  // rows and columns of those terms are summed.
+  
+  int n = numTerms();
+  
+  vector< bool > termChanged( n, false );
+  bool anyTermChanged = false;
+  
+  for( int i = 0; i < n; ++i ){
+    
+    int iteration = intenManager()->termIteration( i );
+    
+    if( iteration != m_termIteration[i] ){
+      
+      termChanged[i] = true;
+      anyTermChanged = true;
+      m_termIteration[i] = iteration;
+    }
+  }
+  
+  // the followers have local values in the cache at this point so
+  // it needs to be reset in all cases
+  if( !anyTermChanged ){
+    
+    setNormIntMatrix( &(m_normIntSum[0]) );
+    return;
+  }
+  
+  // pack the changed elements, scaled up by the number of events
+  // on this process -- the leader contributes zeroes
+  
+  const double* integrals = normIntMatrix();
+  
+  vector< int > iIndex, jIndex;
+  vector< double > packed;
+  
+  for( int i = 0; i < n; ++i ){
+    for( int j = 0; j <= i; ++j ){
+      
+      if( !termChanged[i] && !termChanged[j] ) continue;
+      
+      iIndex.push_back( i );
+      jIndex.push_back( j );
+      
+      packed.push_back( m_isLeader ? 0 : integrals[2*i*n+2*j] * numGenEvents() );
+      packed.push_back( m_isLeader ? 0 : integrals[2*i*n+2*j+1] * numGenEvents() );
+    }
+  }
+  
+  vector< double > result( packed.size() );
+  
+  MPI_Allreduce( &(packed[0]), &(result[0]), packed.size(), MPI_DOUBLE,
+                 MPI_SUM, RankGroupMPI::comm() );
+  
+  for( unsigned int iElem = 0; iElem < iIndex.size(); ++iElem ){
+    
+    int i = iIndex[iElem];
+    int j = jIndex[iElem];
+    
+    double re = result[2*iElem] / m_totalGenEvents;
+    double im = result[2*iElem+1] / m_totalGenEvents;
+    
+    m_normIntSum[2*i*n+2*j]   = re;
+    m_normIntSum[2*i*n+2*j+1] = im;
+    m_normIntSum[2*j*n+2*i]   = re;
+    m_normIntSum[2*j*n+2*i+1] = -im;
+  }
+  
+  setNormIntMatrix( &(m_normIntSum[0]) );
+}
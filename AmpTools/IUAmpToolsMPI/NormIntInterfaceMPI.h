@@ -62,9 +62,20 @@ private:
   
   void setupMPI();
   void sumIntegrals( IntType type ) const;
+  void sumChangedIntegrals() const;
   
   bool m_mpiSetup;
   
+  // the sum over all processes of the normalization integrals -- this
+  // is needed to rebuild the full matrix when only changed elements
+  // are summed, since followers overwrite the cache with local values
+  mutable vector< double > m_normIntSum;
+  
+  // the iteration number of each term at the last sum, used to find
+  // the terms whose parameters have changed since then
+  mutable vector< int > m_termIteration;
+  mutable int m_totalGenEvents;
+  
   int m_rank;
   int m_numProc;
   bool m_isLeader;
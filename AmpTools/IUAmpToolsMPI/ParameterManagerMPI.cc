@@ -40,6 +40,7 @@
 
 #include "IUAmpToolsMPI/ParameterManagerMPI.h"
 #include "IUAmpToolsMPI/MPITag.h"
+#include "IUAmpToolsMPI/RankGroupMPI.h"
 
 #include "IUAmpTools/report.h"
 const char* ParameterManagerMPI::kModule = "ParameterManagerMPI";
@@ -133,8 +134,8 @@ ParameterManagerMPI::~ParameterManagerMPI()
 void
 ParameterManagerMPI::setupMPI()
 {
-  MPI_Comm_rank( MPI_COMM_WORLD, &m_rank );
-  MPI_Comm_size( MPI_COMM_WORLD, &m_numProc );
+  MPI_Comm_rank( RankGroupMPI::comm(), &m_rank );
+  MPI_Comm_size( RankGroupMPI::comm(), &m_numProc );
 
   m_isLeader = ( m_rank == 0 );
 }
@@ -284,7 +285,7 @@ void ParameterManagerMPI::updateParameters()
     parData[i++] = *(parItr->second);
   }
 
-  MPI_Bcast( parData, i, MPI_DOUBLE, 0, MPI_COMM_WORLD );
+  MPI_Bcast( parData, i, MPI_DOUBLE, 0, RankGroupMPI::comm() );
   
   if( !m_isLeader ){
     
@@ -334,19 +335,23 @@ void ParameterManagerMPI::updateAmpParameter( const string& parName )
     assert( nameLength <= kMaxNameLength );
     strcpy( parNameArr, parItr->first.c_str() );
     
-    MPI_Bcast( &nameLength, 1, MPI_INT, 0, MPI_COMM_WORLD );
-    MPI_Bcast( parNameArr, nameLength, MPI_CHAR, 0, MPI_COMM_WORLD );
+    MPI_Bcast( &nameLength, 1, MPI_INT, 0, RankGroupMPI::comm() );
+    MPI_Bcast( parNameArr, nameLength, MPI_CHAR, 0, RankGroupMPI::comm() );
     
     value = *(parItr->second);
     
-    MPI_Bcast( &value, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD );
+    MPI_Bcast( &value, 1, MPI_DOUBLE, 0, RankGroupMPI::comm() );
     
+    // the leader does not compute amplitudes but notifies them anyway
+    // so that all processes agree on which terms have changed
+    // (see NormIntInterfaceMPI::sumChangedIntegrals)
+    ParameterManager::update( parName );
   }
   else{
     
-    MPI_Bcast( &nameLength, 1, MPI_INT, 0, MPI_COMM_WORLD );
-    MPI_Bcast( parNameArr, nameLength, MPI_CHAR, 0, MPI_COMM_WORLD );
-    MPI_Bcast( &value, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD );
+    MPI_Bcast( &nameLength, 1, MPI_INT, 0, RankGroupMPI::comm() );
+    MPI_Bcast( parNameArr, nameLength, MPI_CHAR, 0, RankGroupMPI::comm() );
+    MPI_Bcast( &value, 1, MPI_DOUBLE, 0, RankGroupMPI::comm() );
     
     ostringstream name;
     for( int i = 0; i < nameLength; ++i ) name << parNameArr[i];
@@ -0,0 +1,90 @@
+
+//******************************************************************************
+// This file is part of AmpTools, a package for performing Amplitude Analysis
+//
+// Copyright Trustees of Indiana University 2010, all rights reserved
+//
+// This software written by Matthew Shepherd, Ryan Mitchell, and
+//                  Hrayr Matevosyan at Indiana University, Bloomington
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice and author attribution, this list of conditions and the
+//    following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice and author attribution, this list of conditions and the
+//    following disclaimer in the documentation and/or other materials
+//    provided with the distribution.
+// 3. Neither the name of the University nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// Creation of derivative forms of this software for commercial
+// utilization may be subject to restriction; written permission may be
+// obtained from the Trustees of Indiana University.
+//
+// INDIANA UNIVERSITY AND THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES,
+// EXPRESS OR IMPLIED.  By way of example, but not limitation, INDIANA
+// UNIVERSITY MAKES NO REPRESENTATIONS OR WARRANTIES OF MERCANTABILITY OR
+// FITNESS FOR ANY PARTICULAR PURPOSE OR THAT THE USE OF THIS SOFTWARE OR
+// DOCUMENTATION WILL NOT INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS,
+// OR OTHER RIGHTS.  Neither Indiana University nor the authors shall be
+// held liable for any liability with respect to any claim by the user or
+// any other party arising from use of the program.
+//******************************************************************************
+
+#include <cassert>
+
+#include "IUAmpToolsMPI/RankGroupMPI.h"
+
+#include "IUAmpTools/report.h"
+const char* RankGroupMPI::kModule = "RankGroupMPI";
+
+void
+RankGroupMPI::setup(){
+  
+  if( m_isSetup ) return;
+  m_isSetup = true;
+  
+  if( m_numGroups <= 1 ){
+    
+    m_numGroups = 1;
+    return;
+  }
+  
+  int rank, numProc;
+  MPI_Comm_rank( MPI_COMM_WORLD, &rank );
+  MPI_Comm_size( MPI_COMM_WORLD, &numProc );
+  
+  // the leader of each group does not compute likelihood sums and
+  // so every group needs at least one follower
+  if( numProc < 2 * m_numGroups ){
+    
+    report( ERROR, kModule ) << "Requested " << m_numGroups << " groups "
+    << "but there are only " << numProc << " processes.\n"
+    << "\tEach group must have at least two processes." << endl;
+    assert( false );
+  }
+  
+  // groups are contiguous blocks of ranks so that rank 0 leads group 0
+  m_group = ( rank * m_numGroups ) / numProc;
+  MPI_Comm_split( MPI_COMM_WORLD, m_group, rank, &m_groupComm );
+  
+  int groupRank;
+  MPI_Comm_rank( m_groupComm, &groupRank );
+  
+  MPI_Comm_split( MPI_COMM_WORLD, ( groupRank == 0 ? 0 : MPI_UNDEFINED ),
+                  rank, &m_leaderComm );
+  
+  report( DEBUG, kModule ) << "Process " << rank << " is in group " << m_group
+  << " with rank " << groupRank << endl;
+}
+
+bool RankGroupMPI::m_isSetup = false;
+int RankGroupMPI::m_numGroups = 1;
+int RankGroupMPI::m_group = 0;
+
+MPI_Comm RankGroupMPI::m_groupComm = MPI_COMM_WORLD;
+MPI_Comm RankGroupMPI::m_leaderComm = MPI_COMM_NULL;
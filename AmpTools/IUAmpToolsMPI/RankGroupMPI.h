@@ -0,0 +1,112 @@
+#if !defined(RANKGROUPMPI)
+#define RANKGROUPMPI
+
+
+//******************************************************************************
+// This file is part of AmpTools, a package for performing Amplitude Analysis
+//
+// Copyright Trustees of Indiana University 2010, all rights reserved
+//
+// This software written by Matthew Shepherd, Ryan Mitchell, and
+//                  Hrayr Matevosyan at Indiana University, Bloomington
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice and author attribution, this list of conditions and the
+//    following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice and author attribution, this list of conditions and the
+//    following disclaimer in the documentation and/or other materials
+//    provided with the distribution.
+// 3. Neither the name of the University nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// Creation of derivative forms of this software for commercial
+// utilization may be subject to restriction; written permission may be
+// obtained from the Trustees of Indiana University.
+//
+// INDIANA UNIVERSITY AND THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES,
+// EXPRESS OR IMPLIED.  By way of example, but not limitation, INDIANA
+// UNIVERSITY MAKES NO REPRESENTATIONS OR WARRANTIES OF MERCANTABILITY OR
+// FITNESS FOR ANY PARTICULAR PURPOSE OR THAT THE USE OF THIS SOFTWARE OR
+// DOCUMENTATION WILL NOT INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS,
+// OR OTHER RIGHTS.  Neither Indiana University nor the authors shall be
+// held liable for any liability with respect to any claim by the user or
+// any other party arising from use of the program.
+//******************************************************************************
+
+#include <mpi.h>
+
+/**
+ * This class divides the processes of an MPI job into a number of groups.
+ * Each group consists of a leader and a set of followers and performs
+ * the full likelihood calculation on its own copy of the data, exactly
+ * as a job with a single group would do.  The leader of the first group
+ * (rank 0 in MPI_COMM_WORLD) runs the minimization.  The leaders of the
+ * other groups wait for requests from it to evaluate the likelihood at
+ * different points in parameter space.  This allows evaluations that
+ * MINUIT needs at the same time, like the steps for numerical derivatives,
+ * to be computed concurrently when adding processes within one group
+ * no longer helps because there are too few events per process.
+ *
+ * All of the MPI classes in AmpTools communicate within the group
+ * communicator returned by comm().  With the default of one group this
+ * is MPI_COMM_WORLD and the behavior is unchanged.
+ *
+ * \ingroup IUAmpToolsMPI
+ */
+
+class RankGroupMPI
+{
+  
+public:
+  
+  enum Command { kEvaluate, kExit };
+  
+  /**
+   * Set the number of groups.  This must be called on all processes
+   * before the AmpToolsInterfaceMPI is constructed.  Each group must
+   * have at least two processes.
+   *
+   * \param[in] numGroups the number of groups
+   */
+  static void setNumGroups( int numGroups ) { m_numGroups = numGroups; }
+  
+  /**
+   * This creates the communicators.  It is collective over MPI_COMM_WORLD
+   * and is called by the constructor of AmpToolsInterfaceMPI.  Subsequent
+   * calls have no effect.
+   */
+  static void setup();
+  
+  /**
+   * The communicator for the group that this process belongs to.
+   */
+  static MPI_Comm comm() { return m_groupComm; }
+  
+  /**
+   * A communicator that contains the leaders of all groups, where the
+   * rank in this communicator is the group number.  This is MPI_COMM_NULL
+   * on processes that are not group leaders.
+   */
+  static MPI_Comm leaderComm() { return m_leaderComm; }
+  
+  static int numGroups() { return m_numGroups; }
+  static int group() { return m_group; }
+  
+private:
+  
+  static bool m_isSetup;
+  static int m_numGroups;
+  static int m_group;
+  
+  static MPI_Comm m_groupComm;
+  static MPI_Comm m_leaderComm;
+  
+  static const char* kModule;
+};
+
+#endif
@@ -0,0 +1,165 @@
+//******************************************************************************
+// This file is part of AmpTools, a package for performing Amplitude Analysis
+//
+// Copyright Trustees of Indiana University 2010, all rights reserved
+//
+// This software written by Matthew Shepherd, Ryan Mitchell, and
+//                  Hrayr Matevosyan at Indiana University, Bloomington
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice and author attribution, this list of conditions and the
+//    following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice and author attribution, this list of conditions and the
+//    following disclaimer in the documentation and/or other materials
+//    provided with the distribution.
+// 3. Neither the name of the University nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// Creation of derivative forms of this software for commercial
+// utilization may be subject to restriction; written permission may be
+// obtained from the Trustees of Indiana University.
+//
+// INDIANA UNIVERSITY AND THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES,
+// EXPRESS OR IMPLIED.  By way of example, but not limitation, INDIANA
+// UNIVERSITY MAKES NO REPRESENTATIONS OR WARRANTIES OF MERCANTABILITY OR
+// FITNESS FOR ANY PARTICULAR PURPOSE OR THAT THE USE OF THIS SOFTWARE OR
+// DOCUMENTATION WILL NOT INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS,
+// OR OTHER RIGHTS.  Neither Indiana University nor the authors shall be
+// held liable for any liability with respect to any claim by the user or
+// any other party arising from use of the program.
+//******************************************************************************
+
+#include <cassert>
+#include <cstring>
+
+#include "IUAmpTools/AmpVecs.h"
+
+#include "IUAmpToolsMPI/SharedMemoryMPI.h"
+#include "IUAmpToolsMPI/RankGroupMPI.h"
+
+#include "IUAmpTools/report.h"
+const char* SharedMemoryMPI::kModule = "SharedMemoryMPI";
+
+void
+SharedMemoryMPI::setup(){
+  
+  if( m_isSetup || !m_useShared ) return;
+  m_isSetup = true;
+  
+  int rank, groupRank;
+  MPI_Comm_rank( MPI_COMM_WORLD, &rank );
+  MPI_Comm_rank( RankGroupMPI::comm(), &groupRank );
+  
+  MPI_Comm nodeComm;
+  MPI_Comm_split_type( MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, rank,
+                       MPI_INFO_NULL, &nodeComm );
+  
+  // twins have the same rank in their group and live on the same node
+  MPI_Comm_split( nodeComm, groupRank, rank, &m_twinComm );
+  MPI_Comm_free( &nodeComm );
+  
+  int numTwins;
+  MPI_Comm_size( m_twinComm, &numTwins );
+  
+  report( DEBUG, kModule ) << "Process " << rank << " has " << numTwins - 1
+  << " other processes on the node with the same data" << endl;
+}
+
+void
+SharedMemoryMPI::shareFourVecs( AmpVecs& ampVecs ){
+  
+  if( !m_isSetup ) return;
+  
+  int twinRank, numTwins;
+  MPI_Comm_rank( m_twinComm, &twinRank );
+  MPI_Comm_size( m_twinComm, &numTwins );
+  
+  if( numTwins == 1 ) return;
+  
+  // the data are only shared if all twins have identical data -- this
+  // may not be the case if the groups are not the same size
+  unsigned long long local[3] = { ampVecs.m_iNEvents,
+                                  static_cast< unsigned long long >( ampVecs.m_iNParticles ),
+                                  checksum( ampVecs ) };
+  unsigned long long minVal[3], maxVal[3];
+  
+  MPI_Allreduce( local, minVal, 3, MPI_UNSIGNED_LONG_LONG, MPI_MIN, m_twinComm );
+  MPI_Allreduce( local, maxVal, 3, MPI_UNSIGNED_LONG_LONG, MPI_MAX, m_twinComm );
+  
+  if( memcmp( minVal, maxVal, sizeof( local ) ) != 0 ){
+    
+    report( NOTICE, kModule ) << "Data are not identical on processes of the "
+    << "same node, keeping private copies." << endl;
+    return;
+  }
+  
+  if( ampVecs.m_pdData == NULL ) return;
+  
+  MPI_Aint size = 4 * ampVecs.m_iNParticles * ampVecs.m_iNEvents * sizeof( GDouble );
+  
+  // the first twin owns the window and the others map it
+  GDouble* base;
+  MPI_Win win;
+  MPI_Win_allocate_shared( ( twinRank == 0 ? size : 0 ), sizeof( GDouble ),
+                           MPI_INFO_NULL, m_twinComm, &base, &win );
+  
+  MPI_Aint querySize;
+  int dispUnit;
+  MPI_Win_shared_query( win, 0, &querySize, &dispUnit, &base );
+  assert( querySize == size );
+  
+  MPI_Win_fence( 0, win );
+  if( twinRank == 0 ) memcpy( base, ampVecs.m_pdData, size );
+  MPI_Win_fence( 0, win );
+  
+  ampVecs.adoptExternalFourVecs( base );
+  m_windows.push_back( win );
+  
+  report( DEBUG, kModule ) << "Sharing " << size << " bytes of four-vectors with "
+  << numTwins - 1 << " processes." << endl;
+}
+
+void
+SharedMemoryMPI::freeWindows(){
+  
+  for( vector< MPI_Win >::iterator win = m_windows.begin();
+       win != m_windows.end(); ++win ){
+    
+    MPI_Win_free( &(*win) );
+  }
+  
+  m_windows.clear();
+}
+
+unsigned long long
+SharedMemoryMPI::checksum( const AmpVecs& ampVecs ){
+  
+  // FNV-1a hash of the four-vectors
+  unsigned long long hash = 14695981039346656037ULL;
+  
+  if( ampVecs.m_pdData == NULL ) return hash;
+  
+  const unsigned char* byte =
+  reinterpret_cast< const unsigned char* >( ampVecs.m_pdData );
+  unsigned long long nBytes =
+  4 * ampVecs.m_iNParticles * ampVecs.m_iNEvents * sizeof( GDouble );
+  
+  for( unsigned long long i = 0; i < nBytes; ++i ){
+    
+    hash ^= byte[i];
+    hash *= 1099511628211ULL;
+  }
+  
+  return hash;
+}
+
+bool SharedMemoryMPI::m_useShared = false;
+bool SharedMemoryMPI::m_isSetup = false;
+
+MPI_Comm SharedMemoryMPI::m_twinComm = MPI_COMM_NULL;
+vector< MPI_Win > SharedMemoryMPI::m_windows;
@@ -0,0 +1,111 @@
+#if !defined(SHAREDMEMORYMPI)
+#define SHAREDMEMORYMPI
+
+//******************************************************************************
+// This file is part of AmpTools, a package for performing Amplitude Analysis
+//
+// Copyright Trustees of Indiana University 2010, all rights reserved
+//
+// This software written by Matthew Shepherd, Ryan Mitchell, and
+//                  Hrayr Matevosyan at Indiana University, Bloomington
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+// 1. Redistributions of source code must retain the above copyright
+//    notice and author attribution, this list of conditions and the
+//    following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright
+//    notice and author attribution, this list of conditions and the
+//    following disclaimer in the documentation and/or other materials
+//    provided with the distribution.
+// 3. Neither the name of the University nor the names of its contributors
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+//
+// Creation of derivative forms of this software for commercial
+// utilization may be subject to restriction; written permission may be
+// obtained from the Trustees of Indiana University.
+//
+// INDIANA UNIVERSITY AND THE AUTHORS MAKE NO REPRESENTATIONS OR WARRANTIES,
+// EXPRESS OR IMPLIED.  By way of example, but not limitation, INDIANA
+// UNIVERSITY MAKES NO REPRESENTATIONS OR WARRANTIES OF MERCANTABILITY OR
+// FITNESS FOR ANY PARTICULAR PURPOSE OR THAT THE USE OF THIS SOFTWARE OR
+// DOCUMENTATION WILL NOT INFRINGE ANY PATENTS, COPYRIGHTS, TRADEMARKS,
+// OR OTHER RIGHTS.  Neither Indiana University nor the authors shall be
+// held liable for any liability with respect to any claim by the user or
+// any other party arising from use of the program.
+//******************************************************************************
+
+#include <vector>
+
+#include <mpi.h>
+
+class AmpVecs;
+
+using namespace std;
+
+/**
+ * This class allows processes on the same node that hold identical
+ * four-vectors to keep a single copy of them in an MPI-3 shared memory
+ * window.  Processes with the same rank in groups of equal size, see
+ * RankGroupMPI, receive the same slice of the data and are considered
+ * "twins."  With one group there are no twins and nothing is shared.
+ *
+ * Sharing is optional and only happens at points where all processes
+ * are synchronized, i.e., when the Monte Carlo is loaded at the
+ * construction of the NormIntInterfaceMPI.
+ *
+ * \ingroup IUAmpToolsMPI
+ */
+
+class SharedMemoryMPI
+{
+  
+public:
+  
+  /**
+   * Turn the sharing on or off.  This must be called on all processes
+   * before the AmpToolsInterfaceMPI is constructed.
+   */
+  static void setUseSharedMemory( bool useShared ) { m_useShared = useShared; }
+  static bool useSharedMemory() { return m_useShared; }
+  
+  /**
+   * This creates the node and twin communicators.  It is collective over
+   * MPI_COMM_WORLD and must be called after RankGroupMPI::setup.
+   * Subsequent calls have no effect.
+   */
+  static void setup();
+  
+  /**
+   * This moves the four-vectors of the AmpVecs object into a shared window
+   * if they are identical on all twins.  It is collective over the twins
+   * and does nothing if sharing is turned off or there are no twins.
+   *
+   * \param[in] ampVecs the object that holds the data, which must be
+   * the host if the data are shared within the process
+   */
+  static void shareFourVecs( AmpVecs& ampVecs );
+  
+  /**
+   * This frees all of the windows.  It is collective over the twins and
+   * should be called after the data are no longer needed and before
+   * MPI_Finalize.
+   */
+  static void freeWindows();
+  
+private:
+  
+  static unsigned long long checksum( const AmpVecs& ampVecs );
+  
+  static bool m_useShared;
+  static bool m_isSetup;
+  
+  static MPI_Comm m_twinComm;
+  static vector< MPI_Win > m_windows;
+  
+  static const char* kModule;
+};
+
+#endif
@@ -99,6 +99,13 @@ MinuitMinimizationManager::evaluateFunction() {
    return totalContribution;
 }
 
+double
+MinuitMinimizationManager::evaluateFunction( const std::vector<double>& par ) {
+  
+  m_fitter.SetParameterList( par );
+  return evaluateFunction();
+}
+
 void
 MinuitMinimizationManager::computeDerivatives( double* grad )
 { 
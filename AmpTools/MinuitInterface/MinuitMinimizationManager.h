@@ -81,6 +81,10 @@ public:
    // calculate the current value of the function to be minimized
    double evaluateFunction(); // central values
    
+   // calculate the function for a particular set of (external) parameter
+   // values -- this will change the working values of the parameters
+   double evaluateFunction( const std::vector<double>& par );
+   
    // status of the last command attempted
    //   = 0: command executed normally
    //     1: command is blank, ignored
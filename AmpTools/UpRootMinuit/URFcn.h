@@ -26,6 +26,16 @@ public:
    virtual ~URFcn() {}
    
    virtual void operator()( Int_urt &npar, Double_urt *grad, Double_urt &fval, const std::vector<Double_urt>& par, Int_urt flag) = 0;
+
+   // Function objects that are able to evaluate the function at several
+   // parameter points at the same time (e.g., with different groups of
+   // processors) can override these two methods.  Minuit collects
+   // independent evaluations, like the finite-difference steps used for
+   // derivatives, and passes them to evaluateBatch when the maximum
+   // number of concurrent evaluations is larger than one.
+   virtual Int_urt maxConcurrentEvaluations() const { return 1; }
+   virtual void evaluateBatch( const std::vector< std::vector<Double_urt> >& parList,
+                               std::vector<Double_urt>& fvalList, Int_urt flag ) {}
 };
 
 #endif
@@ -56,6 +56,7 @@ URMinuit::URMinuit() :
 
    fStatus     = 0;
    fEmpty      = 0;
+   fSeed       = 12345;
    SetMaxIterations();
    mninit(5,6,7);
 }
@@ -77,6 +78,7 @@ URMinuit::URMinuit(Int_urt maxpar) :
 
    fStatus     = 0;
    fEmpty      = 0;
+   fSeed       = 12345;
    SetMaxIterations();
 
    mninit(5,6,7);
@@ -417,6 +419,33 @@ Int_urt URMinuit::Eval(Int_urt npar, Double_urt *grad, Double_urt &fval, const v
    return 0;
 }
 
+//______________________________________________________________________________
+Int_urt URMinuit::EvalBatch(Int_urt npar, const vector< vector<Double_urt> >& parList, vector<Double_urt>& fvalList, Int_urt flag)
+{
+// Evaluate the minimisation function for a list of independent sets
+// of (external) parameters.  If the function object is able to do
+// several evaluations concurrently the whole list is passed to it,
+// otherwise the points are evaluated one after another.  The external
+// parameter list is left in an undefined state and callers should
+// restore it with mninex.  The function call counter is incremented
+// by the number of points.
+
+   fvalList.resize( parList.size() );
+   if (parList.empty()) return 0;
+
+   if (canEvalBatch()) {
+      fFCN->evaluateBatch( parList, fvalList, flag );
+   } else {
+      for (unsigned int k = 0; k < parList.size(); ++k) {
+         m_userParameterValue = parList[k];
+         Eval(npar, fGin, fvalList[k], m_userParameterValue, flag);
+      }
+   }
+
+   fNfcn += parList.size();
+   return 0;
+}
+
 //______________________________________________________________________________
 bool URMinuit::parameterFixed( Int_urt externalParameterId )
 {
@@ -1956,6 +1985,7 @@ void URMinuit::mnderi()
 	tlrstp = .1;
 	tlrgrd = .02;
     }
+    if (canEvalBatch()) goto L200;
 //*-*-                               loop over variable parameters
     for (i = 1; i <= fNpar; ++i) {
 	epspri = fEpsma2 + URMath::Abs(fGrd[i-1]*fEpsma2);
@@ -2015,6 +2045,83 @@ L50:
     }
     mninex(fX);
     return;
+//*-*-        same calculation as above, but the cycles are done for all
+//*-*-        parameters together so that the steps for different parameters
+//*-*-        can be evaluated concurrently by the FCN
+L200:
+    {
+       vector<Double_urt> xtfv(fNpar), epspv(fNpar), stepb4v(fNpar, 0), stepv(fNpar);
+       vector<Double_urt> stpminv(fNpar), optstpv(fNpar), grbforv(fNpar, 0);
+       vector<Bool_urt> donev(fNpar, kurFALSE);
+       vector< vector<Double_urt> > points;
+       vector<Double_urt> fvals;
+       vector<Int_urt> batch;
+
+       for (i = 1; i <= fNpar; ++i) {
+          epspv[i-1] = fEpsma2 + URMath::Abs(fGrd[i-1]*fEpsma2);
+          xtfv[i-1]  = fX[i-1];
+       }
+       for (icyc = 1; icyc <= ncyc; ++icyc) {
+          points.clear();
+          batch.clear();
+          for (i = 1; i <= fNpar; ++i) {
+             if (donev[i-1]) continue;
+             optstp = URMath::Sqrt(dfmin / (URMath::Abs(fG2[i-1]) + epspv[i-1]));
+             step = URMath::Max(optstp,URMath::Abs(fGstep[i-1]*.1));
+             if (fGstep[i-1] < 0 && step > .5) step = .5;
+             stpmax = URMath::Abs(fGstep[i-1])*10;
+             if (step > stpmax) step = stpmax;
+             stpmin = URMath::Abs(fEpsma2*fX[i-1])*8;
+             if (step < stpmin) step = stpmin;
+             if (URMath::Abs((step - stepb4v[i-1]) / step) < tlrstp) {
+                donev[i-1] = kurTRUE;
+                continue;
+             }
+             if (fGstep[i-1] > 0) fGstep[i-1] =  URMath::Abs(step);
+             else                 fGstep[i-1] = -URMath::Abs(step);
+             stepb4v[i-1] = step;
+             stepv[i-1]   = step;
+             stpminv[i-1] = stpmin;
+             optstpv[i-1] = optstp;
+             fX[i-1] = xtfv[i-1] + step;
+             mninex(fX);
+             points.push_back(m_userParameterValue);
+             fX[i-1] = xtfv[i-1] - step;
+             mninex(fX);
+             points.push_back(m_userParameterValue);
+             fX[i-1] = xtfv[i-1];
+             batch.push_back(i);
+          }
+          if (batch.empty()) break;
+          EvalBatch(nparx, points, fvals, 4);
+          for (unsigned int k = 0; k < batch.size(); ++k) {
+             i    = batch[k];
+             step = stepv[i-1];
+             fs1  = fvals[2*k];
+             fs2  = fvals[2*k+1];
+             grbfor = fGrd[i-1];
+             grbforv[i-1] = grbfor;
+             fGrd[i-1] = (fs1 - fs2) / (step*2);
+             fG2[i-1]  = (fs1 + fs2 - fAmin*2) / (step*step);
+             if (ldebug) {
+                d1d2 = (fs1 + fs2 - fAmin*2) / step;
+                std::printf("%4d%11.3g%11.3g%10.2g%10.2g%10.2g%10.2g\n",i,fGrd[i-1],step,stpminv[i-1],optstpv[i-1],d1d2,fG2[i-1]);
+             }
+             if (URMath::Abs(grbfor - fGrd[i-1]) / (URMath::Abs(fGrd[i-1]) + dfmin/step) < tlrgrd)
+                donev[i-1] = kurTRUE;
+          }
+       }
+       if (ncyc != 1) {
+          for (i = 1; i <= fNpar; ++i) {
+             if (donev[i-1]) continue;
+             ostringstream warning2;
+             warning2 << "First derivative not converged. " << fGrd[i-1] << grbforv[i-1];
+             mnwarn("D", "MNDERI", warning2.str().c_str());
+          }
+       }
+    }
+    mninex(fX);
+    return;
 //*-*-                                       .  derivatives calc by fcn
 L100:
     for (iint = 1; iint <= fNpar; ++iint) {
@@ -3172,7 +3279,7 @@ void URMinuit::mngrad()
     Double_urt fzero, err;
     Int_urt i, nparx, lc, istsav;
     Bool_urt lnone;
-    static string cwd = "    ";
+    string cwd = "    ";
 
     fISW[2] = 1;
     nparx   = fNpar;
@@ -3984,6 +4091,35 @@ L30:
 //*-*-                                       . . . .  off-diagonal elements
 
     if (fNpar == 1) goto L214;
+    if (canEvalBatch()) {
+//*-*-        all off-diagonal points are independent -- evaluate together
+       vector< vector<Double_urt> > points;
+       vector<Double_urt> fvals;
+       for (i = 1; i <= fNpar; ++i) {
+          for (j = 1; j <= i-1; ++j) {
+             xti     = fX[i-1];
+             xtj     = fX[j-1];
+             fX[i-1] = xti + fDirin[i-1];
+             fX[j-1] = xtj + fDirin[j-1];
+             mninex(fX);
+             points.push_back(m_userParameterValue);
+             fX[i-1] = xti;
+             fX[j-1] = xtj;
+          }
+       }
+       EvalBatch(nparx, points, fvals, 4);
+       unsigned int k = 0;
+       for (i = 1; i <= fNpar; ++i) {
+          for (j = 1; j <= i-1; ++j) {
+             fs1  = fvals[k++];
+             elem = (fs1 + fAmin - fHESSyy[i-1] - fHESSyy[j-1]) / (
+                     fDirin[i-1]*fDirin[j-1]);
+             ndex = i*(i-1) / 2 + j;
+             fVhmat[ndex-1] = elem;
+          }
+       }
+       goto L214;
+    }
     for (i = 1; i <= fNpar; ++i) {
 	for (j = 1; j <= i-1; ++j) {
 	    xti     = fX[i-1];
@@ -4157,11 +4293,8 @@ void URMinuit::mnimpr()
 //*-*        ref. -- Goldstein and Price, Math.Comp. 25, 569 (1971)
 //*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
 
-    /* Initialized data */
-
-    static Double_urt rnum = 0;
-
     /* Local variables */
+    Double_urt rnum = 0;
     Double_urt amax, ycalf, ystar, ystst;
     Double_urt pb, ep, wg, xi, sigsav, reg, sig2;
     Int_urt npfn, ndex, loop=0, i, j, ifail, iseed;
@@ -6278,9 +6411,9 @@ void URMinuit::mnprin(Int_urt inkode, Double_urt fval)
     /* Initialized data */
 
     static string cblank = "           ";
-    static string cnambf = "           ";
 
     /* Local variables */
+    string cnambf = "           ";
     Double_urt dcmax, x1, x2, x3, dc;
     x2 = x3 = 0;
     Int_urt nadd, i, k, l, m, ikode, ic, nc, ntrail, lbl;
@@ -6682,22 +6815,18 @@ void URMinuit::mnrn15(Double_urt &val, Int_urt &inseed)
 //*-*                    Set Default Starting Seed
 //*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*-*
 
-    /* Initialized data */
-
-    static Int_urt iseed = 12345;
-
     Int_urt k;
 
     if (val == 3) goto L100;
-    inseed = iseed;
-    k      = iseed / 53668;
-    iseed  = (iseed - k*53668)*40014 - k*12211;
-    if (iseed < 0) iseed += 2147483563;
-    val = Double_urt(iseed*4.656613e-10);
+    inseed = fSeed;
+    k      = fSeed / 53668;
+    fSeed  = (fSeed - k*53668)*40014 - k*12211;
+    if (fSeed < 0) fSeed += 2147483563;
+    val = Double_urt(fSeed*4.656613e-10);
     return;
 //*-*               "entry" to set seed, flag is VAL=3
 L100:
-    iseed = inseed;
+    fSeed = inseed;
 } /* mnrn15_ */
 
 //______________________________________________________________________________
@@ -51,6 +51,7 @@ public:
   Int_urt        fMaxcpt;
   Int_urt        fMaxpar2;          // fMaxpar*fMaxpar
   Int_urt        fMaxpar1;          // fMaxpar*(fMaxpar+1)
+  Int_urt        fSeed;             //Seed of the random number generator in MNRN15
   
   Double_urt     fAmin;             //Minimum value found for FCN
   Double_urt     fUp;               //FCN+-UP defines errors (for chisquare fits UP=1)
@@ -197,6 +198,8 @@ public:
                                    Double_urt upperLimit );
   virtual void   DeleteArrays();
   virtual Int_urt  Eval(Int_urt npar, Double_urt *grad, Double_urt &fval, const std::vector<Double_urt>& par, Int_urt flag);
+  virtual Int_urt  EvalBatch(Int_urt npar, const std::vector< std::vector<Double_urt> >& parList, std::vector<Double_urt>& fvalList, Int_urt flag);
+  bool             canEvalBatch() const { return fFCN && fFCN->maxConcurrentEvaluations() > 1; }
   virtual Int_urt  FixParameter( Int_urt parNo );
   bool           parameterFixed( Int_urt parameterNumber );
   Int_urt          GetMaxIterations() const {return fMaxIterations;}
@@ -206,6 +209,7 @@ public:
   virtual Int_urt  GetParameter( Int_urt parNo, Double_urt &currentValue, Double_urt &currentError ) const;
   Int_urt          GetStatus() const {return fStatus;}
   const std::vector<Double_urt>& GetParameterList() const {return m_userParameterValue;}
+  void             SetParameterList( const std::vector<Double_urt>& par ) {m_userParameterValue = par;}
   virtual Int_urt  Migrad( Double_urt tolerance );
   virtual Int_urt  Minos();
   virtual Int_urt  Hesse();
@@ -5,6 +5,7 @@
 #include <vector>
 #include <utility>
 #include <map>
+#include <cstdlib>
 #include <mpi.h>
 #include "IUAmpTools/ConfigFileParser.h"
 #include "IUAmpTools/ConfigurationInfo.h"
@@ -37,7 +38,7 @@ int main( int argc, char* argv[] ){
 
   if (argc <= 1){
     report( INFO, kModule ) << "Usage:" << endl << endl;
-    report( INFO, kModule ) << "\tfitAmplitudesMPI <config file name>" << endl << endl;
+    report( INFO, kModule ) << "\tfitAmplitudesMPI <config file name> [threads per process] [groups]" << endl << endl;
     MPI_Finalize();
     return 0;
   }
@@ -53,6 +54,26 @@ int main( int argc, char* argv[] ){
 
   report( INFO, kModule ) << "Config file name:  " << cfgname << endl << endl;
 
+    // optionally run one process per node and use threads for
+    // the loops over events within each process
+
+  if( argc > 2 ){
+    
+    AmpToolsInterface::setNumThreads( atoi( argv[2] ) );
+    report( INFO, kModule ) << "Threads per process:  "
+                            << EventLoopThreads::numThreads() << endl << endl;
+  }
+
+    // optionally split the processes into groups that evaluate
+    // the likelihood for different parameter values concurrently
+
+  if( argc > 3 ){
+    
+    AmpToolsInterfaceMPI::setNumGroups( atoi( argv[3] ) );
+    report( INFO, kModule ) << "Number of process groups:  "
+                            << atoi( argv[3] ) << endl << endl;
+  }
+
 
     // ************************
     // parse the config file
@@ -0,0 +1,81 @@
+#include <iostream>
+#include <string>
+#include <cstdlib>
+
+#include "IUAmpTools/ConfigFileParser.h"
+#include "IUAmpTools/ConfigurationInfo.h"
+#include "IUAmpTools/AmpToolsInterface.h"
+#include "IUAmpTools/MultiStartFit.h"
+#include "IUAmpTools/FitResults.h"
+#include "DalitzDataIO/DalitzDataReader.h"
+#include "DalitzAmp/BreitWigner.h"
+#include "DalitzAmp/Constraint.h"
+
+#include "IUAmpTools/report.h"
+static const char* kModule = "fitMultiStart";
+
+
+using namespace std;
+
+int main( int argc, char* argv[] ){
+
+  if (argc <= 2){
+    report( INFO, kModule ) << "Usage:" << endl << endl;
+    report( INFO, kModule ) << "\tfitMultiStart <config file name> <number of fits> "
+                            << "[number of concurrent fits] [seed]" << endl << endl;
+    return 0;
+  }
+
+    // ************************
+    // usage
+    // ************************
+
+  report( INFO, kModule ) << " *** Performing the Fits *** " << endl;
+
+
+    // ************************
+    // parse the command line parameters
+    // ************************
+
+  string cfgname(argv[1]);
+  unsigned int nStarts = atoi( argv[2] );
+  unsigned int nConcurrent = ( argc > 3 ? atoi( argv[3] ) : 0 );
+  unsigned long long seed = ( argc > 4 ? atoll( argv[4] ) : 0 );
+
+  report( INFO, kModule ) << "Config file name:  " << cfgname << endl << endl;
+
+
+    // ************************
+    // parse the config file
+    // ************************
+
+  ConfigFileParser parser(cfgname);
+  ConfigurationInfo* cfgInfo = parser.getConfigurationInfo();
+  cfgInfo->display();
+
+
+    // ************************
+    // perform the fits
+    // ************************
+
+  AmpToolsInterface::registerAmplitude(BreitWigner());
+  AmpToolsInterface::registerNeg2LnLikContrib(Constraint());
+  AmpToolsInterface::registerDataReader(DalitzDataReader());
+
+  MultiStartFit multiStart(cfgInfo);
+  multiStart.setNumStarts( nStarts );
+  multiStart.setNumConcurrentFits( nConcurrent );
+  multiStart.setSeed( seed );
+
+  multiStart.fit( cfgInfo->fitOutputFileName( "starts" ) );
+
+  if( multiStart.bestFit() == NULL ) return 1;
+
+  report( INFO, kModule ) << "-2 ln(L) OF THE BEST FIT:  "
+                          << multiStart.bestFit()->likelihood() << endl;
+
+  multiStart.bestFit()->writeResults( cfgInfo->fitOutputFileName() );
+
+  return 0;
+
+}
@@ -1,15 +1,19 @@
 #include <iostream>
 #include <string>
+#include <vector>
+#include <cmath>
 #include "TString.h"
 #include "TH1F.h"
 #include "TFile.h"
-#include "TGenPhaseSpace.h"
 #include "TLorentzVector.h"
 #include "IUAmpTools/Kinematics.h"
 #include "IUAmpTools/AmplitudeManager.h"
 #include "IUAmpTools/ConfigFileParser.h"
 #include "IUAmpTools/ConfigurationInfo.h"
 #include "IUAmpTools/AmpToolsInterface.h"
+#include "IUAmpTools/EventLoopThreads.h"
+#include "IUAmpTools/MCGenerator.h"
+#include "IUAmpTools/CounterRandom.h"
 #include "DalitzDataIO/DalitzDataReader.h"
 #include "DalitzDataIO/DalitzDataWriter.h"
 #include "DalitzAmp/BreitWigner.h"
@@ -20,6 +24,175 @@ static const char* kModule = "generatePhysics";
 
 using namespace std;
 
+
+  // ************************
+  // three-body phase space for the decay of a parent at rest:
+  //  points are generated uniformly in (s12,s23), which is flat
+  //  in phase space, using only the random numbers of the event
+  //  so that the output does not depend on the number of threads
+  //
+  //  resonances can be added to generate a fraction of the events
+  //  with a Breit-Wigner distribution in the invariant mass squared
+  //  of a pair;  the weight returned is the ratio of the flat density
+  //  to the density of this proposal, so that the accept/reject
+  //  still gives the intensity but is much more efficient for
+  //  narrow resonances
+  // ************************
+
+class DalitzPhaseSpace : public MCGenerator::PhaseSpace {
+
+public:
+
+  DalitzPhaseSpace( double parentMass, const double* masses ) :
+    m_M( parentMass ), m_flatFraction( 0.2 ){
+
+    for( int i = 0; i < 3; i++ ) m_m[i] = masses[i];
+
+    // the pairs are (12), (23), and (13)
+    for( int p = 0; p < 3; p++ ){
+
+      int i = ( p == 1 ? 1 : 0 );
+      int j = ( p == 0 ? 1 : 2 );
+      int k = 3 - i - j;
+      m_sLow[p] = ( m_m[i] + m_m[j] ) * ( m_m[i] + m_m[j] );
+      m_sHigh[p] = ( m_M - m_m[k] ) * ( m_M - m_m[k] );
+    }
+  }
+
+  unsigned int numParticles() const { return 3; }
+
+  void setFlatFraction( double fraction ) { m_flatFraction = fraction; }
+
+  void addResonance( double mass, double width, int daughter1, int daughter2 ){
+
+    Resonance res;
+    res.pair = ( daughter1 + daughter2 == 3 ? 0 : ( daughter1 + daughter2 == 5 ? 1 : 2 ) );
+    res.m2 = mass * mass;
+    res.mGamma = mass * width;
+    res.thetaLow = atan( ( m_sLow[res.pair] - res.m2 ) / res.mGamma );
+    res.thetaHigh = atan( ( m_sHigh[res.pair] - res.m2 ) / res.mGamma );
+    m_resonances.push_back( res );
+  }
+
+  double generate( CounterRandom& rng, GDouble* fourVecs ) const {
+
+    double M2 = m_M*m_M;
+    double m1 = m_m[0], m2 = m_m[1], m3 = m_m[2];
+    double sumS = M2 + m1*m1 + m2*m2 + m3*m3;
+
+    double s[3];
+    double E1, E3, p1, p3, cos13;
+
+    while( true ){
+
+      // two of the invariant masses squared are generated and
+      // the third is fixed by their sum
+
+      int p = 0, q = 1;
+      double u = rng.uniform();
+      if( m_resonances.empty() || u < m_flatFraction ){
+
+        s[p] = rng.uniform( m_sLow[p], m_sHigh[p] );
+        s[q] = rng.uniform( m_sLow[q], m_sHigh[q] );
+      }
+      else{
+
+        unsigned int iRes = ( u - m_flatFraction ) / ( 1 - m_flatFraction ) *
+                            m_resonances.size();
+        iRes = min( iRes, (unsigned int)m_resonances.size() - 1 );
+        const Resonance& res = m_resonances[iRes];
+
+        p = res.pair;
+        q = ( p + 1 ) % 3;
+        s[p] = res.m2 + res.mGamma * tan( rng.uniform( res.thetaLow, res.thetaHigh ) );
+        s[q] = rng.uniform( m_sLow[q], m_sHigh[q] );
+      }
+      int r = 3 - p - q;
+      s[r] = sumS - s[p] - s[q];
+      if( s[r] < m_sLow[r] || s[r] > m_sHigh[r] ) continue;
+
+      E3 = ( M2 + m3*m3 - s[0] ) / ( 2*m_M );
+      E1 = ( M2 + m1*m1 - s[1] ) / ( 2*m_M );
+      double E2 = m_M - E1 - E3;
+      if( E1 < m1 || E2 < m2 || E3 < m3 ) continue;
+
+      p1 = sqrt( E1*E1 - m1*m1 );
+      p3 = sqrt( E3*E3 - m3*m3 );
+      double p2sq = E2*E2 - m2*m2;
+      if( p1 == 0 || p3 == 0 ) continue;
+
+      // momentum balance fixes the angle between particles 1 and 3
+      cos13 = ( p2sq - p1*p1 - p3*p3 ) / ( 2*p1*p3 );
+      if( fabs( cos13 ) <= 1 ) break;
+    }
+
+    // random orientation:  the direction of particle 3 and the
+    // azimuth of particle 1 around it
+
+    double cosTheta = rng.uniform( -1, 1 );
+    double sinTheta = sqrt( 1 - cosTheta*cosTheta );
+    double phi = rng.uniform( 0, 2*M_PI );
+    double psi = rng.uniform( 0, 2*M_PI );
+
+    double e3[3] = { sinTheta*cos(phi), sinTheta*sin(phi), cosTheta };
+    double e1[3] = { cosTheta*cos(phi), cosTheta*sin(phi), -sinTheta };
+    double e2[3] = { -sin(phi), cos(phi), 0 };
+
+    double sin13 = sqrt( 1 - cos13*cos13 );
+    double p1vec[3], p3vec[3];
+    for( int k = 0; k < 3; k++ ){
+
+      p3vec[k] = p3*e3[k];
+      p1vec[k] = p1*( cos13*e3[k] + sin13*( cos(psi)*e1[k] + sin(psi)*e2[k] ) );
+    }
+
+    fourVecs[0] = E1;
+    fourVecs[4] = m_M - E1 - E3;
+    fourVecs[8] = E3;
+    for( int k = 0; k < 3; k++ ){
+
+      fourVecs[1+k] = p1vec[k];
+      fourVecs[5+k] = -p1vec[k] - p3vec[k];
+      fourVecs[9+k] = p3vec[k];
+    }
+
+    if( m_resonances.empty() ) return 1;
+
+    // the density of the proposal relative to the flat density
+
+    double flatDensity = 1 / ( ( m_sHigh[0] - m_sLow[0] ) * ( m_sHigh[1] - m_sLow[1] ) );
+    double density = m_flatFraction * flatDensity;
+    for( unsigned int iRes = 0; iRes < m_resonances.size(); ++iRes ){
+
+      const Resonance& res = m_resonances[iRes];
+      int q = ( res.pair + 1 ) % 3;
+      double ds = s[res.pair] - res.m2;
+      double bw = res.mGamma / ( ds*ds + res.mGamma*res.mGamma ) /
+                  ( res.thetaHigh - res.thetaLow );
+      density += ( 1 - m_flatFraction ) / m_resonances.size() *
+                 bw / ( m_sHigh[q] - m_sLow[q] );
+    }
+
+    return flatDensity / density;
+  }
+
+private:
+
+  struct Resonance {
+
+    int pair;
+    double m2, mGamma;
+    double thetaLow, thetaHigh;
+  };
+
+  double m_M;
+  double m_m[3];
+  double m_sLow[3], m_sHigh[3];
+  double m_flatFraction;
+  vector< Resonance > m_resonances;
+};
+
+
 int main(int argc, char** argv){
 
 
@@ -32,12 +205,12 @@ int main(int argc, char** argv){
     report( NOTICE, kModule ) << "Usage:" << endl;
     report( NOTICE, kModule ) << "\tgeneratePhysics <config file name> <output file name> <number of events>" << endl << endl;
     report( NOTICE, kModule ) << "\tgeneratePhysics <config file name> <output file name> <number of events> <seed>" << endl << endl;
+    report( NOTICE, kModule ) << "\tgeneratePhysics <config file name> <output file name> <number of events> <seed> <threads>" << endl << endl;
     return 0;
   }
-  if (argc == 5) {
-    int seed = stoi(argv[4]);
-    srand48(seed);
-  }
+  unsigned long long seed = 0;
+  if (argc > 4) seed = stoull(argv[4]);
+  if (argc > 5) EventLoopThreads::setNumThreads(atoi(argv[5]));
 
   report( INFO, kModule ) << endl << " *** Generating Events According to Amplitudes *** " << endl << endl;
 
@@ -88,76 +261,36 @@ int main(int argc, char** argv){
 
 
     // ************************
-    // use ROOT to generate phase space
+    // generate phase space, calculate intensities, and do accept/reject
+    //  in chunks, writing the accepted events as they are produced
     // ************************
 
-  TGenPhaseSpace generator;
-  TLorentzVector parent(0.0, 0.0, 0.0, 3.0);
   double daughterMasses[3] = {0.2, 0.2, 0.2};
-  generator.SetDecay(parent, 3, daughterMasses);
-  double maxWeight = generator.GetWtMax();
-
-
-    // ************************
-    // first generate a set of phase space events
-    // ************************
-
-  report( DEBUG, kModule ) << "generating phase space..." << endl;
-
-  for (int i = 0; i < nevents; i++){
-
-      // generate the decay
-
-    double weight = generator.Generate();
-    if (weight < drand48() * maxWeight){
-      i--;  continue;
+  DalitzPhaseSpace phaseSpace(3.0, daughterMasses);
+
+    // use the Breit-Wigner amplitudes with fixed masses and widths
+    //  as a proposal for the phase space
+
+  vector<AmplitudeInfo*> amps = cfgInfo->amplitudeList(reaction->reactionName());
+  for (unsigned int i = 0; i < amps.size(); i++){
+    const vector< vector<string> >& factors = amps[i]->factors();
+    for (unsigned int j = 0; j < factors.size(); j++){
+      if (factors[j].size() != 5 || factors[j][0] != "BreitWigner") continue;
+      double mass = atof(factors[j][1].c_str());
+      double width = atof(factors[j][2].c_str());
+      if (mass <= 0 || width <= 0) continue;
+      phaseSpace.addResonance(mass, width, atoi(factors[j][3].c_str()),
+                                           atoi(factors[j][4].c_str()));
     }
-
-
-      // pack the decay products into a Kinematics object
-
-    vector<TLorentzVector> fourvectors;
-    fourvectors.push_back( TLorentzVector( *generator.GetDecay(0) ) );
-    fourvectors.push_back( TLorentzVector( *generator.GetDecay(1) ) );
-    fourvectors.push_back( TLorentzVector( *generator.GetDecay(2) ) );
-    Kinematics* kin = new Kinematics(fourvectors);
-
-
-      // load events into the AmpToolsInterface
-
-    ATI.loadEvent(kin,i,nevents);
-
-    delete kin;
-
   }
 
-  report( DEBUG, kModule ) << "... finished generating phase space" << endl;
 
-    
-    // ************************
-    // calculate intensities for all events
-    // ************************
-
-  report( DEBUG, kModule ) << "calculating intensities..." << endl;
-  double maxIntensity = 1.2 * ATI.processEvents(reaction->reactionName());
-  report( DEBUG, kModule ) << "... finished calculating intensities" << endl;
+  MCGenerator generator(*ATI.intensityManager(reaction->reactionName()),
+                        phaseSpace, dataWriter, seed);
 
-
-    // ************************
-    // loop over all events again and do accept/reject
-    // ************************
-
-  report( DEBUG, kModule ) << "doing accept/reject..." << endl;
-  for (int i = 0; i < nevents; i++){
-    double intensity = ATI.intensity(i); 
-    double rndm = drand48() * maxIntensity;
-    if (intensity > rndm){
-      Kinematics* kin = ATI.kinematics(i);
-      dataWriter.writeEvent(*kin);
-      delete kin;
-    }
-  }
-  report( DEBUG, kModule ) << "... finished doing accept/reject" << endl;
+  report( DEBUG, kModule ) << "generating events..." << endl;
+  generator.generate(nevents);
+  report( DEBUG, kModule ) << "... finished generating events" << endl;
 
   report( INFO, kModule ) << "KEPT " << dataWriter.eventCounter() << " events" << endl;
 
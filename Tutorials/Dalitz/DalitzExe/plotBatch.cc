@@ -0,0 +1,100 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include "IUAmpTools/AmpToolsInterface.h"
+#include "IUAmpTools/FitResults.h"
+#include "IUAmpTools/PlotBatch.h"
+#include "IUAmpTools/EventLoopThreads.h"
+#include "DalitzDataIO/DalitzDataReader.h"
+#include "DalitzAmp/BreitWigner.h"
+#include "DalitzPlot/DalitzPlotGenerator.h"
+
+#include "IUAmpTools/report.h"
+static const char* kModule = "plotBatch";
+
+using namespace std;
+
+int main( int argc, char* argv[] ){
+
+
+    // ************************
+    // usage
+    // ************************
+
+  if (argc < 3){
+    report( NOTICE, kModule ) << "Usage:" << endl << endl;
+    report( NOTICE, kModule ) << "\tplotBatch <fit results name> <output file name> "
+                              << "[configuration file] [number of threads]" << endl << endl;
+    report( NOTICE, kModule ) << "Each line of the configuration file is a configuration name" << endl;
+    report( NOTICE, kModule ) << "followed by the amplitudes and sums that are enabled.  Without" << endl;
+    report( NOTICE, kModule ) << "a file, all amplitudes and each amplitude alone are plotted." << endl;
+    return 0;
+  }
+
+  report( INFO, kModule ) << endl << " *** Plotting All Configurations *** " << endl << endl;
+
+
+    // ************************
+    // parse the command line parameters
+    // ************************
+
+  string resultsname(argv[1]);
+  string outname(argv[2]);
+  string cfgname( argc > 3 ? argv[3] : "" );
+  if( argc > 4 ) EventLoopThreads::setNumThreads( atoi( argv[4] ) );
+
+  report( INFO, kModule ) << "Fit results file name    = " << resultsname << endl;
+  report( INFO, kModule ) << "Output file name    = " << outname << endl << endl;
+
+
+    // ************************
+    // set up a PlotGenerator and the configurations
+    // ************************
+
+  FitResults results( resultsname );
+
+  AmpToolsInterface::registerDataReader( DalitzDataReader() );
+  AmpToolsInterface::registerAmplitude( BreitWigner() );
+
+  DalitzPlotGenerator plotGenerator( results );
+  PlotBatch batch( plotGenerator );
+
+  if( cfgname.empty() ){
+
+    batch.addAmplitudeConfigurations();
+  }
+  else{
+
+    ifstream cfgfile( cfgname.c_str() );
+    if( !cfgfile ){
+      report( ERROR, kModule ) << "Could not open " << cfgname << endl;
+      return 1;
+    }
+
+    string line;
+    while( getline( cfgfile, line ) ){
+
+      istringstream fields( line );
+      string name, item;
+      if( !( fields >> name ) || name[0] == '#' ) continue;
+
+      vector<string> enabled;
+      while( fields >> item ) enabled.push_back( item );
+
+      batch.addConfiguration( name, enabled );
+    }
+  }
+
+
+    // ************************
+    // make and write all of the plots
+    // ************************
+
+  batch.writePlots( outname );
+
+  return 0;
+
+}
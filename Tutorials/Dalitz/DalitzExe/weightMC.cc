@@ -0,0 +1,83 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include "IUAmpTools/AmpToolsInterface.h"
+#include "IUAmpTools/FitResults.h"
+#include "IUAmpTools/ConfigurationInfo.h"
+#include "IUAmpTools/IntensityWeighter.h"
+#include "IUAmpTools/EventLoopThreads.h"
+#include "DalitzDataIO/DalitzDataReader.h"
+#include "DalitzDataIO/DalitzDataWriter.h"
+#include "DalitzAmp/BreitWigner.h"
+
+#include "IUAmpTools/report.h"
+static const char* kModule = "weightMC";
+
+using namespace std;
+
+int main( int argc, char* argv[] ){
+
+
+    // ************************
+    // usage
+    // ************************
+
+  if (argc < 4){
+    report( NOTICE, kModule ) << "Usage:" << endl << endl;
+    report( NOTICE, kModule ) << "\tweightMC <fit results name> <input file name> <output file name> "
+                              << "[number of threads] [amplitude 1] [amplitude 2] ..." << endl << endl;
+    report( NOTICE, kModule ) << "The events of the input file are written with weights given by" << endl;
+    report( NOTICE, kModule ) << "the intensity of the fit, using only the listed amplitudes" << endl;
+    report( NOTICE, kModule ) << "(reaction::sum::amp) if any are given." << endl;
+    return 0;
+  }
+
+  report( INFO, kModule ) << endl << " *** Weighting Events by the Fit Intensity *** " << endl << endl;
+
+
+    // ************************
+    // parse the command line parameters
+    // ************************
+
+  string resultsname(argv[1]);
+  string infilename(argv[2]);
+  string outfilename(argv[3]);
+  if( argc > 4 ) EventLoopThreads::setNumThreads( atoi( argv[4] ) );
+
+  vector<string> amps;
+  for( int i = 5; i < argc; i++ ) amps.push_back( argv[i] );
+
+  report( INFO, kModule ) << "Fit results file name = " << resultsname << endl;
+  report( INFO, kModule ) << "Input file name       = " << infilename << endl;
+  report( INFO, kModule ) << "Output file name      = " << outfilename << endl << endl;
+
+
+    // ************************
+    // set up the weighter for the first reaction
+    // ************************
+
+  FitResults results( resultsname );
+
+  AmpToolsInterface::registerAmplitude( BreitWigner() );
+
+  string reactionName = results.configInfo()->reactionList()[0]->reactionName();
+  IntensityWeighter weighter( results, reactionName );
+  if( !amps.empty() ) weighter.setAmplitudes( amps );
+
+
+    // ************************
+    // read, weight, and write the events
+    // ************************
+
+  vector<string> readerArgs;
+  readerArgs.push_back( infilename );
+  DalitzDataReader reader( readerArgs );
+
+  DalitzDataWriter writer( outfilename );
+
+  weighter.weightEvents( reader, writer );
+
+  return 0;
+
+}
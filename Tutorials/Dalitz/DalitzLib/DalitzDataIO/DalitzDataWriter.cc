@@ -82,3 +82,42 @@ DalitzDataWriter::writeEvent( const Kinematics& kin ){
   m_eventCounter++;
 
 }
+
+
+void
+DalitzDataWriter::writeEvents( const GDouble* fourVecs, const GDouble* weights,
+                               unsigned long long nEvents, unsigned int nParticles ){
+
+  assert( nParticles == 3 );
+
+  for( unsigned long long iEvent = 0; iEvent < nEvents; ++iEvent ){
+
+    const GDouble* p = fourVecs + 12*iEvent;
+
+    m_EnP1 = p[0];
+    m_PxP1 = p[1];
+    m_PyP1 = p[2];
+    m_PzP1 = p[3];
+
+    m_EnP2 = p[4];
+    m_PxP2 = p[5];
+    m_PyP2 = p[6];
+    m_PzP2 = p[7];
+
+    m_EnP3 = p[8];
+    m_PxP3 = p[9];
+    m_PyP3 = p[10];
+    m_PzP3 = p[11];
+
+    m_s12 = (m_EnP1+m_EnP2)*(m_EnP1+m_EnP2) - (m_PxP1+m_PxP2)*(m_PxP1+m_PxP2)
+          - (m_PyP1+m_PyP2)*(m_PyP1+m_PyP2) - (m_PzP1+m_PzP2)*(m_PzP1+m_PzP2);
+    m_s23 = (m_EnP2+m_EnP3)*(m_EnP2+m_EnP3) - (m_PxP2+m_PxP3)*(m_PxP2+m_PxP3)
+          - (m_PyP2+m_PyP3)*(m_PyP2+m_PyP3) - (m_PzP2+m_PzP3)*(m_PzP2+m_PzP3);
+
+    m_weight = weights[iEvent];
+
+    m_outTree->Fill();
+
+    m_eventCounter++;
+  }
+}
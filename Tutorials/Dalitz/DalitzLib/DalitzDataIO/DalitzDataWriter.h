@@ -2,11 +2,12 @@
 #define DALITZDATAWRITER
 
 #include "IUAmpTools/Kinematics.h"
+#include "IUAmpTools/EventSink.h"
 
 #include "TTree.h"
 #include "TFile.h"
 
-class DalitzDataWriter{
+class DalitzDataWriter : public EventSink {
 
 public:
 		
@@ -15,6 +16,11 @@ public:
 
   void writeEvent( const Kinematics& kin );
 
+  // write a batch of events from arrays of four-vectors (as
+  // provided by MCGenerator or IntensityWeighter)
+  void writeEvents( const GDouble* fourVecs, const GDouble* weights,
+                    unsigned long long nEvents, unsigned int nParticles );
+
   int eventCounter() const { return m_eventCounter; }
 
 private:
@@ -8,6 +8,7 @@
 #include "IUAmpTools/ConfigFileParser.h"
 #include "IUAmpTools/ConfigurationInfo.h"
 #include "IUAmpTools/AmpToolsInterface.h"
+#include "IUAmpTools/BinnedDataReader.h"
 #include "DalitzDataIO/DalitzDataReader.h"
 #include "DalitzAmp/BreitWigner.h"
 #include "DalitzAmp/Constraint.h"
@@ -102,6 +103,42 @@ int main() {
     double neg2LL_symmetrized_explicit;
     fin >> neg2LL_symmetrized_explicit;
     unit_test.add(neg2LL_symmetrized_explicit, ATI.likelihood("symmetrized_explicit"), 1e-4, "Likelihood of symmetrized (explicit) reaction after fit matches model");
+
+    // split the Monte Carlo into two shards of different size, merge the
+    // integrals of the shards, and compare with the integrals of the full sample
+    NormIntInterface* normInt = ATI.normIntInterface("base");
+    IntensityManager* intenMan = ATI.intensityManager("base");
+    normInt->forceCacheUpdate();
+    unsigned int nSplit = 0;
+    auto everyThird = [&nSplit](const Kinematics&) { return (nSplit++ % 3 == 0 ? 0 : 1); };
+    DalitzDataReader genMC(vector<string>(1, "phasespace.gen.root"));
+    DalitzDataReader accMC(vector<string>(1, "phasespace.acc.root"));
+    BinnedDataReader::split("genShard", &genMC, 2, everyThird);
+    nSplit = 0;
+    BinnedDataReader::split("accShard", &accMC, 2, everyThird);
+    vector<string> shards;
+    for (unsigned int iShard = 0; iShard < 2; ++iShard) {
+        BinnedDataReader genShard(vector<string>{"genShard", to_string(iShard)});
+        BinnedDataReader accShard(vector<string>{"accShard", to_string(iShard)});
+        NormIntInterface shard(&genShard, &accShard, *intenMan);
+        shard.forceCacheUpdate();
+        shards.push_back("normIntShard" + to_string(iShard) + ".ni");
+        shard.exportNormIntCache(shards.back());
+    }
+    NormIntInterface::mergeNormIntFiles(shards, "normIntMerged.ni");
+    NormIntInterface merged("normIntMerged.ni");
+    unit_test.add(merged.numGenEvents() == normInt->numGenEvents(), "Merged normalization integrals have the generated events of the full sample");
+    unit_test.add(merged.numAccEvents(), normInt->numAccEvents(), 1e-6, "Merged normalization integrals have the accepted weights of the full sample");
+    double maxDiff = 0;
+    vector<string> terms = intenMan->getTermNames();
+    for (const string& amp : terms) {
+        for (const string& conjAmp : terms) {
+            maxDiff = max(maxDiff, abs(merged.normInt(amp, conjAmp, true) - normInt->normInt(amp, conjAmp, true)));
+            maxDiff = max(maxDiff, abs(merged.ampInt(amp, conjAmp, true) - normInt->ampInt(amp, conjAmp, true)));
+        }
+    }
+    unit_test.add(maxDiff, 0, 1e-9, "Merged normalization integrals match those of the full sample");
+
     bool result = unit_test.summary();
 
     if (!result) {
@@ -6,6 +6,7 @@
 #include <utility>
 #include <map>
 #include <mpi.h>
+#include <sys/stat.h>
 #include "IUAmpTools/ConfigFileParser.h"
 #include "IUAmpTools/ConfigurationInfo.h"
 #include "IUAmpToolsMPI/AmpToolsInterfaceMPI.h"
@@ -76,6 +77,29 @@ int main( int argc, char* argv[] ) {
     AmpToolsInterfaceMPI::registerAmplitude(BreitWigner());
     AmpToolsInterfaceMPI::registerNeg2LnLikContrib(Constraint());
     AmpToolsInterfaceMPI::registerDataReader(DataReaderMPI<DalitzDataReader>());
+
+    // the first pass loads the generated MC at once and writes each
+    // slice to the data cache, the second reads the generated MC in pieces
+    // while the followers only have their slices in the cache
+    if (rank == 0) mkdir("mpiCache", 0755);
+    MPI_Barrier(MPI_COMM_WORLD);
+    AmpToolsInterface::setDataCacheDirectory("mpiCache");
+    unsigned long long chunkSize = NormIntInterface::genMCChunkSize();
+    double neg2LL_cached[2];
+    for (int pass = 0; pass < 2; ++pass) {
+        NormIntInterface::setGenMCChunkSize(pass == 0 ? 0 : 1000);
+        AmpToolsInterfaceMPI* cachedATI = new AmpToolsInterfaceMPI(cfgInfo);
+        if (rank == 0) {
+            neg2LL_cached[pass] = cachedATI->likelihood();
+            // the followers compute the generated MC integrals here
+            cachedATI->finalizeFit("cached");
+        }
+        cachedATI->exitMPI();
+        delete cachedATI;
+    }
+    AmpToolsInterface::setDataCacheDirectory("");
+    NormIntInterface::setGenMCChunkSize(chunkSize);
+
     AmpToolsInterfaceMPI ATI(cfgInfo);
     AmpToolsInterfaceMPI::setRandomSeed(12345);
     if (rank == 0){
@@ -110,6 +134,7 @@ int main( int argc, char* argv[] ) {
     double neg2LL_symmetrized_explicit;
     fin >> neg2LL_symmetrized_explicit;
     unit_test.add(neg2LL_symmetrized_explicit, ATI.likelihood("symmetrized_explicit"), 1e-4, "Likelihood of symmetrized (explicit) reaction after fit matches model");
+    unit_test.add(neg2LL_cached[1], neg2LL_cached[0], 1e-6, "Likelihood with generated MC slices from the cache matches");
     result = unit_test.summary();
     if (!result) {
         throw runtime_error("Unit Tests Failed. See previous logs for more information.");
@@ -147,6 +147,21 @@ int main()
     FitResults fitResults_from_file("fitTest.fit");
     const FitResults* fr_ff = &fitResults_from_file;
     results.push_back(testFitResults(fr_ff));
+
+    cout << "________________________________________" << endl;
+    cout << "Testing FitResults from binary file:" << endl;
+    cout << "________________________________________" << endl;
+
+    fitResults_from_file.writeBinaryResults("fitTest.bfit");
+    fitResults->writeBinaryResults("fitTest.bfit", true);
+    results.push_back(FitResults::numBinaryResults("fitTest.bfit") == 2);
+    FitResults fitResults_lazy("fitTest.bfit", 0, false);
+    pair<double, double> lazyIntensity = fitResults_lazy.intensity();
+    results.push_back(!fitResults_lazy.configInfoLoaded());
+    results.push_back(abs(lazyIntensity.first - fitResults_from_file.intensity().first) <= 1e-6 * abs(lazyIntensity.first));
+    results.push_back(abs(lazyIntensity.second - fitResults_from_file.intensity().second) <= 1e-6 * abs(lazyIntensity.second));
+    FitResults fitResults_from_binary("fitTest.bfit", 1, false);
+    results.push_back(testFitResults(&fitResults_from_binary));
     for (const bool result : results) {
         if (!result) {
             throw runtime_error("Unit Tests Failed. See previous logs for more information.");